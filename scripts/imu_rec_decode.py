@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Origanization: Rice University & HealthSeers Inc.
+# Project: Cairdio Project
+# Author: Shaun Lin (hl116@rice.edu)
+#
+"""Decode an IMU session recording (see src/imu_rec.h) to CSV.
+
+The input is either the raw recording, or the text captured from the
+"rec dump" shell command (one hex row per line, other lines are ignored).
+
+    imu_rec_decode.py session.txt > session.csv
+"""
+
+import argparse
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x5249
+HDR = struct.Struct("<HHHHI")
+FRAME = struct.Struct("<I3h3h")
+HEX_ROW = re.compile(r"^\s*([0-9a-fA-F]{2})+\s*$")
+
+
+def read_input(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        return data
+    rows = [line.strip() for line in text.splitlines() if HEX_ROW.match(line)]
+    return bytes.fromhex("".join(rows)) if rows else data
+
+
+def nibbles(payload, count):
+    for i in range(count):
+        yield (payload[i // 2] >> ((i & 1) * 4)) & 0xF
+
+
+def varints(nibs):
+    value = shift = 0
+    for nib in nibs:
+        value |= (nib & 0x7) << shift
+        shift += 3
+        if not nib & 0x8:
+            yield value
+            value = shift = 0
+    if shift:
+        raise ValueError("truncated varint")
+
+
+def zigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def to_int16(v):
+    return (v + 0x8000) % 0x10000 - 0x8000
+
+
+def decode_block(block):
+    magic, seq, frames, nibble_count, crc = HDR.unpack_from(block)
+    first = FRAME.unpack_from(block, HDR.size)
+    payload = block[HDR.size + FRAME.size:]
+    if magic != MAGIC or frames == 0 or nibble_count > 2 * len(payload):
+        raise ValueError("bad block header")
+    calc = zlib.crc32(block[:HDR.size - 4])
+    calc = zlib.crc32(block[HDR.size:HDR.size + FRAME.size], calc)
+    calc = zlib.crc32(payload[:(nibble_count + 1) // 2], calc)
+    if calc != crc:
+        raise ValueError("block %d: CRC mismatch" % seq)
+
+    cur = list(first)
+    out = [tuple(cur)]
+    vals = varints(nibbles(payload, nibble_count))
+    dt = 0
+    for _ in range(frames - 1):
+        dt = (dt + zigzag(next(vals))) & 0xFFFFFFFF
+        cur[0] = (cur[0] + dt) & 0xFFFFFFFF
+        for i in range(1, 7):
+            cur[i] = to_int16(cur[i] + zigzag(next(vals)))
+        out.append(tuple(cur))
+    return seq, out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="raw recording or captured 'rec dump' output")
+    parser.add_argument("--block-size", type=int, default=512,
+                        help="CONFIG_IMU_REC_BLOCK_SIZE of the firmware (default: 512)")
+    args = parser.parse_args()
+
+    data = read_input(args.input)
+    if len(data) % args.block_size:
+        sys.exit("recording is not a whole number of %d byte blocks" % args.block_size)
+
+    print("t_us,ax,ay,az,gx,gy,gz")
+    for off in range(0, len(data), args.block_size):
+        seq, frames = decode_block(data[off:off + args.block_size])
+        for frame in frames:
+            print(",".join(str(v) for v in frame))
+
+
+if __name__ == "__main__":
+    main()
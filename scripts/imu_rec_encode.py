@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+#
+# Origanization: Rice University & HealthSeers Inc.
+# Project: Cairdio Project
+# Author: Shaun Lin (hl116@rice.edu)
+#
+"""Encode a CSV trace to an IMU session recording (see src/imu_rec.h).
+
+The CSV holds one frame per line, t_us,ax,ay,az,gx,gy,gz in BMI270
+register units (the format written by imu_rec_decode.py, header line
+optional). The output can be replayed by the BMI270 emulator
+(CONFIG_BMI270_EMUL_TRACE_FILE) and decodes back to the same CSV.
+
+    imu_rec_encode.py session.csv session.bin
+"""
+
+import argparse
+import csv
+import zlib
+
+from imu_rec_decode import FRAME, HDR, MAGIC
+
+
+def zigzag(v):
+    return ((v << 1) ^ (v >> 31)) & 0xFFFFFFFF
+
+
+def to_int32(v):
+    return (v + 0x80000000) % 0x100000000 - 0x80000000
+
+
+def to_int16(v):
+    return (v + 0x8000) % 0x10000 - 0x8000
+
+
+def varint(v):
+    out = []
+    while v >= 0x8:
+        out.append((v & 0x7) | 0x8)
+        v >>= 3
+    out.append(v)
+    return out
+
+
+class Encoder:
+    def __init__(self, block_size):
+        self.block_size = block_size
+        self.capacity = (block_size - HDR.size - FRAME.size) * 2
+        self.blocks = []
+        self.first = None
+
+    def seal(self):
+        payload = bytearray(self.block_size - HDR.size - FRAME.size)
+        for i, nib in enumerate(self.nibs):
+            payload[i // 2] |= nib << ((i & 1) * 4)
+        first = FRAME.pack(*self.first)
+        head = struct_pack_head(len(self.blocks), self.frames, len(self.nibs))
+        crc = zlib.crc32(head)
+        crc = zlib.crc32(first, crc)
+        crc = zlib.crc32(payload[:(len(self.nibs) + 1) // 2], crc)
+        self.blocks.append(head + crc.to_bytes(4, "little") + first + payload)
+        self.first = None
+
+    def push(self, frame):
+        if self.first is not None:
+            dt = (frame[0] - self.prev[0]) & 0xFFFFFFFF
+            nibs = varint(zigzag(to_int32((dt - self.prev_dt) & 0xFFFFFFFF)))
+            for i in range(1, 7):
+                nibs += varint(zigzag(frame[i] - self.prev[i]))
+            if len(self.nibs) + len(nibs) <= self.capacity and self.frames < 0xFFFF:
+                self.nibs += nibs
+                self.frames += 1
+                self.prev = frame
+                self.prev_dt = dt
+                return
+            self.seal()
+        self.first = frame
+        self.prev = frame
+        self.prev_dt = 0
+        self.frames = 1
+        self.nibs = []
+
+    def finish(self):
+        if self.first is not None:
+            self.seal()
+        return b"".join(self.blocks)
+
+
+def struct_pack_head(seq, frames, nibbles):
+    return HDR.pack(MAGIC, seq & 0xFFFF, frames, nibbles, 0)[:HDR.size - 4]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="CSV trace")
+    parser.add_argument("output", help="recording to write")
+    parser.add_argument("--block-size", type=int, default=512,
+                        help="CONFIG_IMU_REC_BLOCK_SIZE of the firmware (default: 512)")
+    args = parser.parse_args()
+
+    enc = Encoder(args.block_size)
+    with open(args.input, newline="") as f:
+        for row in csv.reader(f):
+            if not row or not row[0].strip().lstrip("-").isdigit():
+                continue
+            t = int(row[0]) & 0xFFFFFFFF
+            enc.push([t] + [to_int16(int(v)) for v in row[1:7]])
+
+    with open(args.output, "wb") as f:
+        f.write(enc.finish())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+#
+# Origanization: Rice University & HealthSeers Inc.
+# Project: Cairdio Project
+# Author: Shaun Lin (hl116@rice.edu)
+#
+"""Evaluate the orientation predictor (CONFIG_FUSION_PREDICT) on a recorded session.
+
+The session is replayed through the same complementary filter as
+src/fusion.c. At every frame the fused roll/pitch are predicted one
+horizon ahead with fusion_predict(), and compared with the fused
+orientation actually reached at that time (the ground truth). The error
+of showing the unpredicted orientation is listed as "hold".
+
+The input is a CSV from imu_rec_decode.py, a raw recording or a captured
+"rec dump" output.
+
+    predict_eval.py session.csv --horizon-ms 20 40 60 --tau-ms 20 40 80
+"""
+
+import argparse
+import bisect
+import csv
+import math
+import sys
+
+from imu_rec_decode import decode_block, read_input
+
+ACCEL_RANGE_G = 2           # IMU_ACCEL_RANGE_G
+GYRO_RANGE_DPS = 500        # IMU_GYRO_RANGE_DPS
+GRAVITY = 9.80665
+FUSION_DT_MAX = 0.1
+
+ACC_SCALE = ACCEL_RANGE_G * GRAVITY / 32768.0           # m/s^2 per LSB
+GYR_SCALE = math.radians(GYRO_RANGE_DPS) / 32768.0      # rad/s per LSB
+
+
+def load(path, block_size):
+    if path.endswith(".csv"):
+        with open(path, newline="") as f:
+            rows = [r for r in csv.reader(f) if r and r[0].strip().isdigit()]
+        return [tuple(int(v) for v in r) for r in rows]
+    data = read_input(path)
+    frames = []
+    for off in range(0, len(data) - block_size + 1, block_size):
+        frames.extend(decode_block(data[off:off + block_size])[1])
+    return frames
+
+
+def fuse(frames, tau_ms):
+    """Port of fusion_update(): returns (t, roll, pitch, roll rate, pitch rate) per frame."""
+    out = []
+    roll = pitch = 0.0
+    t_prev = None
+    t_ext = 0
+    for i, (t_us, ax, ay, az, gx, gy, _) in enumerate(frames):
+        # the recording keeps the low 32 bits of the timestamp
+        t_ext = t_us if i == 0 else t_ext + ((t_us - frames[i - 1][0]) & 0xFFFFFFFF)
+        t = t_ext * 1e-6
+        ax, ay, az = ax * ACC_SCALE, ay * ACC_SCALE, az * ACC_SCALE
+        wx, wy = gx * GYR_SCALE, gy * GYR_SCALE
+        roll_acc = math.atan2(ay, az)
+        pitch_acc = math.atan2(-ax, math.hypot(ay, az))
+        dt = None if t_prev is None else t - t_prev
+        if dt is None or dt <= 0 or dt > FUSION_DT_MAX:
+            roll, pitch = roll_acc, pitch_acc
+        else:
+            alpha = tau_ms / (tau_ms + dt * 1000.0)
+            roll = alpha * (roll + wx * dt) + (1 - alpha) * roll_acc
+            pitch = alpha * (pitch + wy * dt) + (1 - alpha) * pitch_acc
+        t_prev = t
+        out.append((t, roll, pitch, wx, wy))
+    return out
+
+
+def predict(angle, rate, horizon, tau):
+    """Port of fusion_predict(), tau None is plain linear extrapolation."""
+    if tau is None:
+        return angle + rate * horizon
+    return angle + rate * tau * (1 - math.exp(-horizon / tau))
+
+
+def truth_at(fused, times, t):
+    j = bisect.bisect_left(times, t)
+    if j == 0 or j >= len(times):
+        return None
+    t0, r0, p0 = fused[j - 1][:3]
+    t1, r1, p1 = fused[j][:3]
+    k = (t - t0) / (t1 - t0)
+    return r0 + k * (r1 - r0), p0 + k * (p1 - p0)
+
+
+def summary(errors):
+    errors = sorted(errors)
+    n = len(errors)
+    rms = math.sqrt(sum(e * e for e in errors) / n)
+    p95 = errors[min(n - 1, int(math.ceil(0.95 * n)) - 1)]
+    return rms, p95, errors[-1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="CSV, raw recording or captured 'rec dump' output")
+    parser.add_argument("--horizon-ms", type=float, nargs="+", default=[20, 40, 60],
+                        help="prediction horizons, sample age + render + transfer (default: 20 40 60)")
+    parser.add_argument("--tau-ms", type=float, nargs="+", default=[20, 40, 80],
+                        help="CONFIG_FUSION_PREDICT_TAU_MS values to compare (default: 20 40 80)")
+    parser.add_argument("--fusion-tau-ms", type=float, default=500,
+                        help="CONFIG_FUSION_TAU_MS of the firmware (default: 500)")
+    parser.add_argument("--block-size", type=int, default=512,
+                        help="CONFIG_IMU_REC_BLOCK_SIZE of the firmware (default: 512)")
+    args = parser.parse_args()
+
+    frames = load(args.input, args.block_size)
+    if len(frames) < 2:
+        sys.exit("not enough frames in %s" % args.input)
+    fused = fuse(frames, args.fusion_tau_ms)
+    times = [f[0] for f in fused]
+
+    print("%d frames, %.1f s" % (len(fused), times[-1] - times[0]))
+    print("%-8s %-10s %10s %10s %10s   (roll/pitch error, deg)" % ("horizon", "predictor", "rms", "p95", "max"))
+    for h_ms in args.horizon_ms:
+        h = h_ms * 1e-3
+        models = [("hold", 0.0)] + [("tau %g" % t, t * 1e-3) for t in args.tau_ms] + [("linear", None)]
+        for name, tau in models:
+            errors = []
+            for t, roll, pitch, wx, wy in fused:
+                truth = truth_at(fused, times, t + h)
+                if truth is None:
+                    continue
+                if tau == 0.0:
+                    pr, pp = roll, pitch
+                else:
+                    pr, pp = predict(roll, wx, h, tau), predict(pitch, wy, h, tau)
+                errors.append(math.degrees(math.hypot(pr - truth[0], pp - truth[1])))
+            rms, p95, worst = summary(errors)
+            print("%-8s %-10s %10.3f %10.3f %10.3f" % ("%g ms" % h_ms, name, rms, p95, worst))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,24 @@
+#
+# Origanization: Rice University & HealthSeers Inc.
+# Project: Cairdio Project
+# Author: Shaun Lin (hl116@rice.edu)
+#
+
+# Slider skin sprites, rendered in the display's color format (sizes as in src/ui_skin.h).
+# Included by the application and by the tests that build its tracking screen.
+if(CONFIG_UI_SKIN_SPRITES)
+  set(ui_sprites ${CMAKE_CURRENT_BINARY_DIR}/ui_sprites.c)
+  if(CONFIG_LV_COLOR_16_SWAP)
+    set(ui_sprites_swap --swap)
+  endif()
+  add_custom_command(
+    OUTPUT ${ui_sprites}
+    COMMAND ${PYTHON_EXECUTABLE} ${CMAKE_CURRENT_LIST_DIR}/ui_sprites.py ${ui_sprites_swap}
+            -o ${ui_sprites}
+            track=pill,200x10,BBBBBB
+            knob_level=circle,22x22,4CAF50,2E7D32,2
+            knob_tilted=circle,22x22,F44336,C62828,2
+    DEPENDS ${CMAKE_CURRENT_LIST_DIR}/ui_sprites.py
+  )
+  target_sources(app PRIVATE ${ui_sprites})
+endif()
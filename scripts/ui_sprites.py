@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+#
+# Origanization: Rice University & HealthSeers Inc.
+# Project: Cairdio Project
+# Author: Shaun Lin (hl116@rice.edu)
+#
+"""Render the widget skin sprites (CONFIG_UI_SKIN_SPRITES) to a C source.
+
+Each sprite is an anti-aliased shape rendered once, at build time, to an
+LVGL LV_IMG_CF_TRUE_COLOR_ALPHA image: RGB565 plus an 8 bit alpha per
+pixel, byte swapped with --swap to match CONFIG_LV_COLOR_16_SWAP. The
+device then blits them instead of running radius masks every frame.
+
+A sprite is given as name=shape,WxH,fill[,border,border_width] with the
+colors in hex and shape one of
+
+    circle  disc of diameter W (W == H), with an optional border ring
+    pill    bar with fully rounded ends, H is the end diameter
+
+    ui_sprites.py --swap -o ui_sprites.c knob=circle,22x22,4CAF50,2E7D32,2
+"""
+
+import argparse
+import math
+
+SUPERSAMPLE = 4  # samples per pixel side for the anti-aliased edges
+
+
+def parse_color(text):
+    v = int(text, 16)
+    return ((v >> 16) & 0xFF, (v >> 8) & 0xFF, v & 0xFF)
+
+
+def parse_sprite(text):
+    name, spec = text.split("=", 1)
+    fields = spec.split(",")
+    w, h = (int(v) for v in fields[1].lower().split("x"))
+    sprite = {
+        "name": name,
+        "shape": fields[0],
+        "w": w,
+        "h": h,
+        "fill": parse_color(fields[2]),
+        "border": parse_color(fields[3]) if len(fields) > 3 else None,
+        "border_width": float(fields[4]) if len(fields) > 4 else 0.0,
+    }
+    if sprite["shape"] not in ("circle", "pill"):
+        raise argparse.ArgumentTypeError(f"{name}: unknown shape {sprite['shape']}")
+    if sprite["shape"] == "circle" and w != h:
+        raise argparse.ArgumentTypeError(f"{name}: a circle needs W == H")
+    return sprite
+
+
+def edge_distance(sprite, x, y):
+    """Distance of a point inside the shape to its outline, negative outside."""
+    r = sprite["h"] / 2.0
+    cy = r
+    if sprite["shape"] == "circle":
+        cx = r
+    else:
+        # nearest point of the pill's center segment
+        cx = min(max(x, r), sprite["w"] - r)
+    return r - math.hypot(x - cx, y - cy)
+
+
+def render(sprite):
+    """Pixels as (r, g, b, a), colors averaged over the covered samples."""
+    n = SUPERSAMPLE
+    pixels = []
+    for py in range(sprite["h"]):
+        for px in range(sprite["w"]):
+            acc = [0, 0, 0]
+            covered = 0
+            for sy in range(n):
+                for sx in range(n):
+                    d = edge_distance(sprite, px + (sx + 0.5) / n, py + (sy + 0.5) / n)
+                    if d < 0:
+                        continue
+                    color = sprite["fill"]
+                    if sprite["border"] is not None and d < sprite["border_width"]:
+                        color = sprite["border"]
+                    for i in range(3):
+                        acc[i] += color[i]
+                    covered += 1
+            if covered == 0:
+                pixels.append((0, 0, 0, 0))
+            else:
+                pixels.append(tuple(round(c / covered) for c in acc) +
+                              (round(255 * covered / (n * n)),))
+    return pixels
+
+
+def rgb565_alpha(pixel, swap):
+    r, g, b, a = pixel
+    v = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+    lo, hi = v & 0xFF, v >> 8
+    return (hi, lo, a) if swap else (lo, hi, a)
+
+
+def emit(sprites, swap, out):
+    out.write("/* Generated by scripts/ui_sprites.py, do not edit. */\n\n")
+    out.write("#include <lvgl.h>\n\n")
+    out.write("#if LV_COLOR_DEPTH != 16 || LV_COLOR_16_SWAP != %d\n" % int(swap))
+    out.write("#error \"ui_sprites.c was rendered for another color format\"\n")
+    out.write("#endif\n")
+
+    for s in sprites:
+        data = []
+        for pixel in render(s):
+            data.extend(rgb565_alpha(pixel, swap))
+        out.write("\nstatic const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST uint8_t "
+                  f"ui_sprite_{s['name']}_map[] = {{\n")
+        row = 3 * s["w"]
+        for i in range(0, len(data), row):
+            out.write("    " + ", ".join(f"0x{b:02x}" for b in data[i:i + row]) + ",\n")
+        out.write("};\n\n")
+        out.write(f"const lv_img_dsc_t ui_sprite_{s['name']} = {{\n")
+        out.write("    .header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA,\n")
+        out.write("    .header.always_zero = 0,\n")
+        out.write("    .header.reserved = 0,\n")
+        out.write(f"    .header.w = {s['w']},\n")
+        out.write(f"    .header.h = {s['h']},\n")
+        out.write(f"    .data_size = {s['w'] * s['h']} * LV_IMG_PX_SIZE_ALPHA_BYTE,\n")
+        out.write(f"    .data = ui_sprite_{s['name']}_map,\n")
+        out.write("};\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("sprites", nargs="+", type=parse_sprite,
+                        help="name=shape,WxH,fill[,border,border_width]")
+    parser.add_argument("-o", "--output", required=True, help="C source to write")
+    parser.add_argument("--swap", action="store_true",
+                        help="byte swap RGB565, for CONFIG_LV_COLOR_16_SWAP")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as out:
+        emit(args.sprites, args.swap, out)
+
+
+if __name__ == "__main__":
+    main()
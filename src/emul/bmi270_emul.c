@@ -0,0 +1,533 @@
+/**
+ * @brief This is the bmi270_emul.c source code of the application. BMI270 SPI emulator replaying recorded sessions.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file bmi270_emul.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page bmi270_emul_page BMI270 Emulator
+ * @brief Serves the BMI270 register map over the SPI emulator bus so the unmodified Zephyr
+ * driver and the whole acquisition-to-UI pipeline run on native_posix.
+ *
+ * The data registers (0x0C-0x17), SENSORTIME (0x18-0x1A) and the FIFO (0x24-0x26, header
+ * or headerless gyro + accel frames) are fed from a session recording in the src/imu_rec.h
+ * format, advanced by one frame per ODR period (ACC_CONF, or GYR_CONF when faster). Each
+ * new frame sets the STATUS/INT_STATUS_1 data-ready bits and drives the node's irq-gpios
+ * on the GPIO emulator; reading the data registers clears them. The configuration upload
+ * (INIT_CTRL/INIT_DATA) is accepted and reports INTERNAL_STATUS "init ok".
+ *
+ * The frames are register values: the application must configure the same ranges as the
+ * recording (IMU_ACCEL_RANGE_G / IMU_GYRO_RANGE_DPS). Without a trace the sensor lies flat
+ * at rest.
+ */
+
+#define DT_DRV_COMPAT bosch_bmi270
+
+// ------------------ Includes ------------------
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include "bmi270_emul.h"
+#include "imu_rec.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(bmi270_emul, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define BMI270_REG_CHIP_ID          0x00
+#define BMI270_REG_STATUS           0x03
+#define BMI270_REG_ACC_X_LSB        0x0C
+#define BMI270_REG_GYR_Z_MSB        0x17
+#define BMI270_REG_SENSORTIME_0     0x18
+#define BMI270_REG_INT_STATUS_1     0x1D
+#define BMI270_REG_INTERNAL_STATUS  0x21
+#define BMI270_REG_FIFO_LENGTH_0    0x24
+#define BMI270_REG_FIFO_LENGTH_1    0x25
+#define BMI270_REG_FIFO_DATA        0x26
+#define BMI270_REG_ACC_CONF         0x40
+#define BMI270_REG_GYR_CONF         0x42
+#define BMI270_REG_FIFO_CONFIG_1    0x49
+#define BMI270_REG_INIT_CTRL        0x59
+#define BMI270_REG_INIT_DATA        0x5E
+#define BMI270_REG_PWR_CTRL         0x7D
+#define BMI270_REG_CMD              0x7E
+#define BMI270_REG_COUNT            0x80
+
+#define BMI270_CHIP_ID              0x24
+#define BMI270_STATUS_DRDY          (BIT(7) | BIT(6)) ///< drdy_acc | drdy_gyr
+#define BMI270_STATUS_CMD_RDY       BIT(4)
+#define BMI270_INT_STATUS_1_DRDY    (BIT(7) | BIT(6)) ///< acc_drdy_int | gyr_drdy_int
+#define BMI270_INTERNAL_STATUS_OK   0x01
+#define BMI270_PWR_CTRL_GYR_EN      BIT(1)
+#define BMI270_PWR_CTRL_ACC_EN      BIT(2)
+#define BMI270_FIFO_CONFIG_1_HEADER BIT(4)
+#define BMI270_FIFO_CONFIG_1_ACC_EN BIT(6)
+#define BMI270_FIFO_CONFIG_1_GYR_EN BIT(7)
+#define BMI270_FIFO_HEADER_REGULAR  0x80
+#define BMI270_FIFO_HEADER_ACC      BIT(2)
+#define BMI270_FIFO_HEADER_GYR      BIT(3)
+#define BMI270_FIFO_EMPTY           0x80
+#define BMI270_FIFO_SIZE            2048
+#define BMI270_CMD_SOFT_RESET       0xB6
+#define BMI270_CMD_FIFO_FLUSH       0xB0
+
+#define BMI270_ODR_100HZ_CODE       8     ///< ODR code of 100 Hz, each step doubles the rate
+#define BMI270_ODR_100HZ_PERIOD_US  10000
+
+// ------------------ Typedefs ------------------
+
+struct bmi270_emul_cfg {
+    struct gpio_dt_spec irq;
+};
+
+struct bmi270_emul_data {
+    const struct emul *target;
+    struct k_spinlock lock;
+    struct k_timer odr_timer;
+    uint8_t regs[BMI270_REG_COUNT];
+
+    const uint8_t *trace;       // recording being replayed, NULL for a device at rest
+    size_t trace_len;
+    size_t block_off;           // offset of the decoded block
+    struct imu_rec_frame frames[IMU_REC_BLOCK_FRAMES_MAX];
+    int n_frames;               // frames in the decoded block
+    int frame_idx;              // frame currently served
+    uint32_t t_offset;          // added to trace timestamps after each loop
+    struct imu_rec_frame cur;   // frame currently served, timestamp adjusted
+    uint32_t served;
+
+    uint8_t fifo[BMI270_FIFO_SIZE];
+    uint16_t fifo_head;
+    uint16_t fifo_len;
+};
+
+// ------------------ Variables ------------------
+
+#ifdef BMI270_EMUL_TRACE
+static const uint8_t bmi270_emul_trace[] __aligned(4) = {
+#include "bmi270_emul_trace.inc"
+};
+#endif
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief ODR period from the ACC_CONF/GYR_CONF rates of the enabled sensors.
+ *
+ * @return uint32_t Period in microseconds, 0 if both sensors are off.
+ */
+static uint32_t bmi270_emul_period_us(const struct bmi270_emul_data *data)
+{
+    uint8_t code = 0;
+
+    if (data->regs[BMI270_REG_PWR_CTRL] & BMI270_PWR_CTRL_ACC_EN) {
+        code = data->regs[BMI270_REG_ACC_CONF] & 0x0F;
+    }
+    if (data->regs[BMI270_REG_PWR_CTRL] & BMI270_PWR_CTRL_GYR_EN) {
+        code = MAX(code, data->regs[BMI270_REG_GYR_CONF] & 0x0F);
+    }
+    if (code == 0) {
+        return 0;
+    }
+
+    return code >= BMI270_ODR_100HZ_CODE ? BMI270_ODR_100HZ_PERIOD_US >> (code - BMI270_ODR_100HZ_CODE)
+                                         : BMI270_ODR_100HZ_PERIOD_US << (BMI270_ODR_100HZ_CODE - code);
+}
+
+static void bmi270_emul_fifo_put(struct bmi270_emul_data *data, const uint8_t *bytes, size_t len)
+{
+    if (data->fifo_len + len > BMI270_FIFO_SIZE) {
+        return; // stop-on-full
+    }
+    for (size_t i = 0; i < len; i++) {
+        data->fifo[(data->fifo_head + data->fifo_len++) % BMI270_FIFO_SIZE] = bytes[i];
+    }
+}
+
+/**
+ * @brief Load the current frame into the register map and the FIFO.
+ */
+static void bmi270_emul_latch(struct bmi270_emul_data *data)
+{
+    const struct imu_rec_frame *f = &data->cur;
+    uint8_t *r = data->regs;
+    uint8_t fifo_cfg = r[BMI270_REG_FIFO_CONFIG_1];
+    uint32_t sensortime = (uint32_t)((uint64_t)f->t_us * 256 / 10000); // 39.0625 us per LSB
+
+    for (int i = 0; i < 3; i++) {
+        sys_put_le16(f->acc[i], &r[BMI270_REG_ACC_X_LSB + 2 * i]);
+        sys_put_le16(f->gyr[i], &r[BMI270_REG_ACC_X_LSB + 6 + 2 * i]);
+    }
+    sys_put_le24(sensortime, &r[BMI270_REG_SENSORTIME_0]);
+    r[BMI270_REG_STATUS] |= BMI270_STATUS_DRDY;
+    r[BMI270_REG_INT_STATUS_1] |= BMI270_INT_STATUS_1_DRDY;
+
+    if (fifo_cfg & (BMI270_FIFO_CONFIG_1_ACC_EN | BMI270_FIFO_CONFIG_1_GYR_EN)) {
+        uint8_t frame[1 + 12];
+        size_t len = 0;
+
+        if (fifo_cfg & BMI270_FIFO_CONFIG_1_HEADER) {
+            frame[len++] = BMI270_FIFO_HEADER_REGULAR |
+                           ((fifo_cfg & BMI270_FIFO_CONFIG_1_GYR_EN) ? BMI270_FIFO_HEADER_GYR : 0) |
+                           ((fifo_cfg & BMI270_FIFO_CONFIG_1_ACC_EN) ? BMI270_FIFO_HEADER_ACC : 0);
+        }
+        // FIFO frames hold gyro before accel
+        if (fifo_cfg & BMI270_FIFO_CONFIG_1_GYR_EN) {
+            memcpy(&frame[len], &r[BMI270_REG_ACC_X_LSB + 6], 6);
+            len += 6;
+        }
+        if (fifo_cfg & BMI270_FIFO_CONFIG_1_ACC_EN) {
+            memcpy(&frame[len], &r[BMI270_REG_ACC_X_LSB], 6);
+            len += 6;
+        }
+        bmi270_emul_fifo_put(data, frame, len);
+    }
+
+    data->served++;
+}
+
+/**
+ * @brief Decode the trace block at data->block_off.
+ */
+static int bmi270_emul_load_block(struct bmi270_emul_data *data)
+{
+    int n = imu_rec_decode_block(&data->trace[data->block_off], data->frames, ARRAY_SIZE(data->frames));
+
+    if (n <= 0) {
+        LOG_ERR("Trace block at %u does not decode: %d", (unsigned int)data->block_off, n);
+        data->n_frames = 0;
+        return -EINVAL;
+    }
+
+    data->n_frames = n;
+    data->frame_idx = 0;
+    return 0;
+}
+
+static void bmi270_emul_set_irq(const struct emul *target, bool active)
+{
+    const struct bmi270_emul_cfg *cfg = target->cfg;
+
+    if (cfg->irq.port == NULL) {
+        return;
+    }
+    gpio_emul_input_set(cfg->irq.port, cfg->irq.pin,
+                        (cfg->irq.dt_flags & GPIO_ACTIVE_LOW) ? !active : active);
+}
+
+/**
+ * @brief Advance to the next frame of the trace, wrapping or stopping at its end.
+ */
+static int bmi270_emul_next(struct bmi270_emul_data *data)
+{
+    if (data->trace == NULL) {
+        data->cur.t_us += bmi270_emul_period_us(data) ?: BMI270_ODR_100HZ_PERIOD_US;
+        return 0;
+    }
+
+    if (++data->frame_idx >= data->n_frames) {
+        if (data->block_off + CONFIG_IMU_REC_BLOCK_SIZE < data->trace_len) {
+            data->block_off += CONFIG_IMU_REC_BLOCK_SIZE;
+        } else if (IS_ENABLED(CONFIG_BMI270_EMUL_TRACE_LOOP)) {
+            // keep time monotonic across loops
+            data->t_offset += data->frames[data->n_frames - 1].t_us -
+                              ((const struct imu_rec_block_hdr *)data->trace)->first.t_us +
+                              (bmi270_emul_period_us(data) ?: BMI270_ODR_100HZ_PERIOD_US);
+            data->block_off = 0;
+        } else {
+            data->frame_idx = data->n_frames - 1;
+            return -ENODATA;
+        }
+        if (bmi270_emul_load_block(data)) {
+            return -ENODATA;
+        }
+    }
+
+    data->cur = data->frames[data->frame_idx];
+    data->cur.t_us += data->t_offset;
+    return 0;
+}
+
+int bmi270_emul_step(const struct emul *target)
+{
+    struct bmi270_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+    int err = bmi270_emul_next(data);
+
+    if (err == 0) {
+        bmi270_emul_latch(data);
+    }
+    k_spin_unlock(&data->lock, key);
+
+    if (err == 0) {
+        bmi270_emul_set_irq(target, true);
+    }
+    return err;
+}
+
+int bmi270_emul_set_trace(const struct emul *target, const uint8_t *blocks, size_t len)
+{
+    struct bmi270_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+    int err = 0;
+
+    data->trace = blocks;
+    data->trace_len = len;
+    data->block_off = 0;
+    data->t_offset = 0;
+    data->served = 0;
+    memset(&data->cur, 0, sizeof(data->cur));
+    data->cur.acc[2] = INT16_MAX / IMU_ACCEL_RANGE_G; // at rest, 1 g on Z
+
+    if (blocks != NULL) {
+        if (len < CONFIG_IMU_REC_BLOCK_SIZE || bmi270_emul_load_block(data)) {
+            data->trace = NULL;
+            err = -EINVAL;
+        } else {
+            data->cur = data->frames[0];
+        }
+    }
+    bmi270_emul_latch(data);
+    k_spin_unlock(&data->lock, key);
+
+    return err;
+}
+
+uint32_t bmi270_emul_frames(const struct emul *target)
+{
+    struct bmi270_emul_data *data = target->data;
+
+    return data->served;
+}
+
+static void bmi270_emul_odr_handler(struct k_timer *timer)
+{
+    struct bmi270_emul_data *data = CONTAINER_OF(timer, struct bmi270_emul_data, odr_timer);
+
+    bmi270_emul_step(data->target);
+}
+
+/**
+ * @brief Restart the ODR timer after a power or rate change.
+ */
+static void bmi270_emul_update_timer(struct bmi270_emul_data *data)
+{
+    uint32_t period = bmi270_emul_period_us(data);
+
+    if (!IS_ENABLED(CONFIG_BMI270_EMUL_FREE_RUN) || period == 0) {
+        k_timer_stop(&data->odr_timer);
+        return;
+    }
+    k_timer_start(&data->odr_timer, K_USEC(period), K_USEC(period));
+}
+
+static void bmi270_emul_reset(struct bmi270_emul_data *data)
+{
+    memset(data->regs, 0, sizeof(data->regs));
+    data->regs[BMI270_REG_CHIP_ID] = BMI270_CHIP_ID;
+    data->regs[BMI270_REG_STATUS] = BMI270_STATUS_CMD_RDY;
+    data->regs[BMI270_REG_ACC_CONF] = 0xA8; // power-on defaults: 100 Hz
+    data->regs[BMI270_REG_GYR_CONF] = 0xA9;
+    data->fifo_head = 0;
+    data->fifo_len = 0;
+}
+
+static uint8_t bmi270_emul_reg_read(struct bmi270_emul_data *data, uint8_t reg)
+{
+    uint8_t val;
+
+    switch (reg) {
+    case BMI270_REG_FIFO_LENGTH_0:
+        return data->fifo_len & 0xFF;
+    case BMI270_REG_FIFO_LENGTH_1:
+        return (data->fifo_len >> 8) & 0x3F;
+    case BMI270_REG_FIFO_DATA:
+        if (data->fifo_len == 0) {
+            return BMI270_FIFO_EMPTY;
+        }
+        val = data->fifo[data->fifo_head];
+        data->fifo_head = (data->fifo_head + 1) % BMI270_FIFO_SIZE;
+        data->fifo_len--;
+        return val;
+    case BMI270_REG_INT_STATUS_1:
+        val = data->regs[reg];
+        data->regs[reg] = 0; // clear on read
+        return val;
+    default:
+        return data->regs[reg];
+    }
+}
+
+static void bmi270_emul_reg_write(struct bmi270_emul_data *data, uint8_t reg, uint8_t val)
+{
+    switch (reg) {
+    case BMI270_REG_CMD:
+        if (val == BMI270_CMD_SOFT_RESET) {
+            bmi270_emul_reset(data);
+            k_timer_stop(&data->odr_timer);
+        } else if (val == BMI270_CMD_FIFO_FLUSH) {
+            data->fifo_len = 0;
+        }
+        break;
+    case BMI270_REG_INIT_CTRL:
+        data->regs[reg] = val;
+        data->regs[BMI270_REG_INTERNAL_STATUS] = (val & 0x01) ? BMI270_INTERNAL_STATUS_OK : 0;
+        break;
+    case BMI270_REG_INIT_DATA:
+        break; // configuration file upload, content is not emulated
+    case BMI270_REG_CHIP_ID:
+    case BMI270_REG_STATUS:
+    case BMI270_REG_INTERNAL_STATUS:
+        break; // read-only
+    case BMI270_REG_ACC_CONF:
+    case BMI270_REG_GYR_CONF:
+    case BMI270_REG_PWR_CTRL:
+        data->regs[reg] = val;
+        bmi270_emul_update_timer(data);
+        break;
+    default:
+        if (reg < BMI270_REG_ACC_X_LSB || reg > BMI270_REG_INT_STATUS_1) {
+            data->regs[reg] = val; // data registers are read-only
+        }
+        break;
+    }
+}
+
+/**
+ * @brief Byte at a position of the full-duplex stream described by a buffer set.
+ */
+static uint8_t spi_buf_set_get(const struct spi_buf_set *set, size_t pos)
+{
+    for (size_t i = 0; set != NULL && i < set->count; i++) {
+        if (pos < set->buffers[i].len) {
+            return set->buffers[i].buf ? ((const uint8_t *)set->buffers[i].buf)[pos] : 0;
+        }
+        pos -= set->buffers[i].len;
+    }
+    return 0;
+}
+
+static void spi_buf_set_put(const struct spi_buf_set *set, size_t pos, uint8_t val)
+{
+    for (size_t i = 0; set != NULL && i < set->count; i++) {
+        if (pos < set->buffers[i].len) {
+            if (set->buffers[i].buf) {
+                ((uint8_t *)set->buffers[i].buf)[pos] = val;
+            }
+            return;
+        }
+        pos -= set->buffers[i].len;
+    }
+}
+
+static size_t spi_buf_set_len(const struct spi_buf_set *set)
+{
+    size_t len = 0;
+
+    for (size_t i = 0; set != NULL && i < set->count; i++) {
+        len += set->buffers[i].len;
+    }
+    return len;
+}
+
+/**
+ * @brief SPI transfer: address byte (bit 7 set for reads), then one dummy byte for reads,
+ * then data with address auto-increment (except for FIFO_DATA and INIT_DATA).
+ */
+static int bmi270_emul_io(const struct emul *target, const struct spi_config *config,
+                          const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+    struct bmi270_emul_data *data = target->data;
+    size_t len = MAX(spi_buf_set_len(tx_bufs), spi_buf_set_len(rx_bufs));
+    uint8_t addr = spi_buf_set_get(tx_bufs, 0);
+    uint8_t reg = addr & 0x7F;
+    bool data_read = false;
+    k_spinlock_key_t key;
+
+    ARG_UNUSED(config);
+
+    if (len == 0) {
+        return -EIO;
+    }
+
+    key = k_spin_lock(&data->lock);
+    if (addr & 0x80) {
+        for (size_t pos = 2; pos < len; pos++) {
+            if (reg >= BMI270_REG_ACC_X_LSB && reg <= BMI270_REG_GYR_Z_MSB) {
+                data_read = true;
+            }
+            spi_buf_set_put(rx_bufs, pos, bmi270_emul_reg_read(data, reg));
+            if (reg != BMI270_REG_FIFO_DATA) {
+                reg = (reg + 1) % BMI270_REG_COUNT;
+            }
+        }
+        if (data_read) {
+            data->regs[BMI270_REG_STATUS] &= ~BMI270_STATUS_DRDY;
+        }
+    } else {
+        for (size_t pos = 1; pos < len; pos++) {
+            bmi270_emul_reg_write(data, reg, spi_buf_set_get(tx_bufs, pos));
+            if (reg != BMI270_REG_INIT_DATA) {
+                reg = (reg + 1) % BMI270_REG_COUNT;
+            }
+        }
+    }
+    k_spin_unlock(&data->lock, key);
+
+    if (data_read) {
+        bmi270_emul_set_irq(target, false);
+    }
+    return 0;
+}
+
+static int bmi270_emul_init(const struct emul *target, const struct device *parent)
+{
+    struct bmi270_emul_data *data = target->data;
+    const struct bmi270_emul_cfg *cfg = target->cfg;
+
+    ARG_UNUSED(parent);
+
+    data->target = target;
+    k_timer_init(&data->odr_timer, bmi270_emul_odr_handler, NULL);
+    bmi270_emul_reset(data);
+
+    if (cfg->irq.port != NULL && !device_is_ready(cfg->irq.port)) {
+        return -ENODEV;
+    }
+
+#ifdef BMI270_EMUL_TRACE
+    return bmi270_emul_set_trace(target, bmi270_emul_trace, sizeof(bmi270_emul_trace));
+#else
+    return bmi270_emul_set_trace(target, NULL, 0);
+#endif
+}
+
+// --------------------------------- Variables ---------------------------------
+
+static struct spi_emul_api bmi270_emul_spi_api = {
+    .io = bmi270_emul_io,
+};
+
+#define BMI270_EMUL_DEFINE(n)                                                       \
+    static struct bmi270_emul_data bmi270_emul_data_##n;                            \
+    static const struct bmi270_emul_cfg bmi270_emul_cfg_##n = {                     \
+        .irq = GPIO_DT_SPEC_INST_GET_OR(n, irq_gpios, {0}),                         \
+    };                                                                              \
+    EMUL_DT_INST_DEFINE(n, bmi270_emul_init, &bmi270_emul_data_##n,                 \
+                        &bmi270_emul_cfg_##n, &bmi270_emul_spi_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(BMI270_EMUL_DEFINE)
@@ -0,0 +1,53 @@
+/**
+ * @brief This is the bmi270_emul.h header of the application. BMI270 SPI emulator replaying recorded sessions.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file bmi270_emul.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef BMI270_EMUL_H_
+#define BMI270_EMUL_H_
+
+// ------------------ Includes ------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/emul.h>
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Replace the trace replayed by the emulator and rewind to its first frame.
+ *
+ * @param target Emulator instance, e.g. EMUL_DT_GET(DT_NODELABEL(bmi270)).
+ * @param blocks Recording in the src/imu_rec.h format, must stay valid while replayed.
+ * @param len Length of the recording, a multiple of CONFIG_IMU_REC_BLOCK_SIZE.
+ * @return int 0 on success, -EINVAL if the first block does not decode.
+ */
+int bmi270_emul_set_trace(const struct emul *target, const uint8_t *blocks, size_t len);
+
+/**
+ * @brief Advance the trace by one frame as if an ODR period elapsed, and raise data ready.
+ *
+ * Normally called from the emulator's ODR timer, tests may call it directly to step the
+ * sensor deterministically with the timer stopped (CONFIG_BMI270_EMUL_FREE_RUN=n).
+ *
+ * @param target Emulator instance.
+ * @return int 0 on success, -ENODATA at the end of a non-looping trace.
+ */
+int bmi270_emul_step(const struct emul *target);
+
+/**
+ * @brief Get the number of frames served since the trace was set.
+ *
+ * @param target Emulator instance.
+ * @return uint32_t Frames served.
+ */
+uint32_t bmi270_emul_frames(const struct emul *target);
+
+#endif /* BMI270_EMUL_H_ */
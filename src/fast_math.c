@@ -0,0 +1,370 @@
+/**
+ * @brief This is the fast_math.c source code of the application. Polynomial and CORDIC approximations of atan2, asin and inverse square root.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file fast_math.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/timing/timing.h>
+#include "fast_math.h"
+
+// ------------------ Macros ------------------
+
+#define FAST_PI_2F      1.57079632679f
+#define FAST_PIF        3.14159265359f
+#define FAST_PI_2_Q13   12868       ///< pi/2 in Q2.13
+#define FAST_PI_2_Q29   843314857   ///< pi/2 in Q2.29
+#define FAST_CORDIC_STEPS 30
+
+// ------------------ Variables ------------------
+
+// atan(2^-i) in Q2.29
+static const int32_t cordic_atan_q29[FAST_CORDIC_STEPS] = {
+    421657428, 248918915, 131521918, 66762579, 33510843, 16771758,
+    8387925, 4194219, 2097141, 1048575, 524288, 262144,
+    131072, 65536, 32768, 16384, 8192, 4096,
+    2048, 1024, 512, 256, 128, 64,
+    32, 16, 8, 4, 2, 1,
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief atan(z) for z in [0, 1], minimax polynomial, 1e-6 rad.
+ */
+static inline float fast_atan_unit(float z)
+{
+    float z2 = z * z;
+
+    return z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f +
+                z2 * (0.05265332f + z2 * -0.01172120f)))));
+}
+
+float fast_atan2f(float y, float x)
+{
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+
+    if (ax == 0.0f && ay == 0.0f) {
+        return 0.0f;
+    }
+
+    // fold to the first octant, then unfold
+    float a = (ay > ax) ? FAST_PI_2F - fast_atan_unit(ax / ay) : fast_atan_unit(ay / ax);
+
+    if (x < 0.0f) {
+        a = FAST_PIF - a;
+    }
+    return (y < 0.0f) ? -a : a;
+}
+
+float fast_asinf(float x)
+{
+    float ax = MIN(fabsf(x), 1.0f);
+    float p = 1.5707963050f + ax * (-0.2145988016f + ax * (0.0889789874f + ax * (-0.0501743046f +
+              ax * (0.0308918810f + ax * (-0.0170881256f + ax * (0.0066700901f +
+              ax * -0.0012624911f))))));
+    float a = FAST_PI_2F - fast_sqrtf(1.0f - ax) * p;
+
+    return (x < 0.0f) ? -a : a;
+}
+
+float fast_rsqrtf(float x)
+{
+    uint32_t i;
+    float y;
+
+    memcpy(&i, &x, sizeof(i));
+    i = 0x5f375a86 - (i >> 1);
+    memcpy(&y, &i, sizeof(y));
+
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y;
+}
+
+int16_t fast_atan2_q15(int16_t y, int16_t x)
+{
+    int32_t ax = abs(x);
+    int32_t ay = abs(y);
+
+    if (ax == 0 && ay == 0) {
+        return 0;
+    }
+
+    bool swap = ay > ax;
+    int32_t z = swap ? (ax << 15) / ay : (ay << 15) / ax; // q15, [0, 1]
+    int32_t z2 = (z * z) >> 15;
+
+    // atan(z) on [0, 1], q15 coefficients, 1e-5 rad before rounding
+    int32_t acc = 683;
+    acc = -2790 + ((acc * z2) >> 15);
+    acc = 5903 + ((acc * z2) >> 15);
+    acc = -10823 + ((acc * z2) >> 15);
+    acc = 32764 + ((acc * z2) >> 15);
+
+    int32_t a = (((acc * z) >> 15) + 2) >> 2; // Q1.15 -> Q2.13
+
+    if (swap) {
+        a = FAST_PI_2_Q13 - a;
+    }
+    if (x < 0) {
+        a = FAST_PI_Q13 - a;
+    }
+    return (int16_t)((y < 0) ? -a : a);
+}
+
+int32_t fast_atan2_q31(int32_t y, int32_t x)
+{
+    // 29 guard bits: |x|, |y| < 2^31, the CORDIC gain 1.65 and sqrt(2) stay below 2^62
+    int64_t xx = (int64_t)x << 29;
+    int64_t yy = (int64_t)y << 29;
+    int32_t a = 0;
+
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+
+    // rotate the left half plane by pi, the iterations cover (-pi/2, pi/2) only
+    if (xx < 0) {
+        xx = -xx;
+        yy = -yy;
+        a = (y >= 0) ? FAST_PI_Q29 : -FAST_PI_Q29;
+    }
+
+    for (int i = 0; i < FAST_CORDIC_STEPS; i++) {
+        int64_t xs = xx >> i;
+        int64_t ys = yy >> i;
+
+        if (yy > 0) {
+            xx += ys;
+            yy -= xs;
+            a += cordic_atan_q29[i];
+        } else {
+            xx -= ys;
+            yy += xs;
+            a -= cordic_atan_q29[i];
+        }
+    }
+    return a;
+}
+
+/**
+ * @brief Integer square root, floor(sqrt(v)), one result bit per step.
+ */
+static uint64_t fast_isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+int16_t fast_asin_q15(int16_t x)
+{
+    // cos(asin(x)) = sqrt(1 - x^2): Q30 -> q15, exactly 1.0 only for x = 0
+    int32_t c = (int32_t)fast_isqrt64((1U << 30) - (uint32_t)((int32_t)x * x));
+
+    return fast_atan2_q15(x, (int16_t)MIN(c, INT16_MAX));
+}
+
+int32_t fast_asin_q31(int32_t x)
+{
+    uint64_t c = fast_isqrt64((1ULL << 62) - (uint64_t)((int64_t)x * x));
+
+    return fast_atan2_q31(x, (int32_t)MIN(c, INT32_MAX));
+}
+
+int32_t fast_rsqrt_q31(int32_t x, int16_t *shift)
+{
+    if (x <= 0) {
+        *shift = 0;
+        return -1;
+    }
+
+    // m = x * 2^n in [0.25, 1) with n even, 1/sqrt(x) = 1/sqrt(m) * 2^(n/2)
+    int n = __builtin_clz((uint32_t)x) - 1;
+
+    n &= ~1;
+    int64_t m = (int64_t)x << n; // q31
+
+    // minimax line for 1/sqrt(m) on [0.25, 1] in Q3.29 (8.7% error), then Newton:
+    // y = y * (3 - m * y^2) / 2, relative error e -> 1.5 e^2 at every step
+    int64_t y = (int64_t)(2.13 * (1 << 29)) - ((m * (int64_t)(1.215 * (1 << 29))) >> 31);
+
+    for (int i = 0; i < 3; i++) {
+        int64_t t = (((y * y) >> 29) * m) >> 31;
+
+        y = (y * ((3LL << 29) - t)) >> 30;
+    }
+
+    // y / 2 in q31 is y in Q3.29 shifted up by one, saturated at m = 0.25 (y = 2)
+    *shift = (int16_t)(n / 2 + 1);
+    return (int32_t)MIN(y << 1, INT32_MAX);
+}
+
+int16_t fast_rsqrt_q15(int16_t x, int16_t *shift)
+{
+    // same value in q31, only the mantissa is rounded back to q15
+    int32_t r = fast_rsqrt_q31((int32_t)x << 16, shift);
+
+    if (r < 0) {
+        return -1;
+    }
+    int32_t q = (int32_t)(((int64_t)r + (1 << 15)) >> 16);
+
+    // powers of four round up to 1.0, which is 0.5 one exponent higher
+    if (q > INT16_MAX) {
+        q = 1 << 14;
+        *shift += 1;
+    }
+    return (int16_t)q;
+}
+
+// ------------------ Shell Commands ------------------
+
+#if defined(CONFIG_SHELL) && defined(CONFIG_TIMING_FUNCTIONS)
+
+#define FAST_BENCH_N 1024
+
+static volatile float sink_f;
+static volatile int32_t sink_q;
+
+/**
+ * @brief Cycles per call of a loop body over FAST_BENCH_N inputs.
+ */
+#define FAST_BENCH(cycles, body)                                                \
+    do {                                                                        \
+        timing_t start = timing_counter_get();                                  \
+        for (int i = 0; i < FAST_BENCH_N; i++) {                                \
+            body;                                                               \
+        }                                                                       \
+        timing_t end = timing_counter_get();                                    \
+        cycles = (uint32_t)(timing_cycles_get(&start, &end) / FAST_BENCH_N);    \
+    } while (0)
+
+static int cmd_fastmath_bench(const struct shell *sh, size_t argc, char **argv)
+{
+    static float in_a[FAST_BENCH_N], in_b[FAST_BENCH_N];
+    uint32_t fast, ref;
+    double err;
+
+    timing_init();
+    timing_start();
+
+    // inputs over the whole range, pseudo-random order so branches are not predictable
+    uint32_t seed = 12345;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        seed = seed * 1103515245 + 12345;
+        in_a[i] = ((int32_t)(seed >> 1) / 1073741824.0f) - 1.0f;
+        seed = seed * 1103515245 + 12345;
+        in_b[i] = ((int32_t)(seed >> 1) / 1073741824.0f) - 1.0f;
+    }
+
+    shell_print(sh, "%-14s %8s %8s %14s", "kernel", "cycles", "libm", "max err");
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        err = MAX(err, fabs(fast_atan2f(in_a[i], in_b[i]) - atan2((double)in_a[i], in_b[i])));
+    }
+    FAST_BENCH(fast, sink_f = fast_atan2f(in_a[i], in_b[i]));
+    FAST_BENCH(ref, sink_f = atan2f(in_a[i], in_b[i]));
+    shell_print(sh, "%-14s %8u %8u %11.2e rad", "atan2f", fast, ref, err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        err = MAX(err, fabs(fast_asinf(in_a[i]) - asin((double)in_a[i])));
+    }
+    FAST_BENCH(fast, sink_f = fast_asinf(in_a[i]));
+    FAST_BENCH(ref, sink_f = asinf(in_a[i]));
+    shell_print(sh, "%-14s %8u %8u %11.2e rad", "asinf", fast, ref, err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        double v = fabsf(in_a[i]) + 1e-3;
+        err = MAX(err, fabs(fast_rsqrtf((float)v) * sqrt(v) - 1.0));
+    }
+    FAST_BENCH(fast, sink_f = fast_rsqrtf(fabsf(in_a[i]) + 1e-3f));
+    FAST_BENCH(ref, sink_f = 1.0f / sqrtf(fabsf(in_a[i]) + 1e-3f));
+    shell_print(sh, "%-14s %8u %8u %11.2e rel", "rsqrtf", fast, ref, err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        int16_t y = (int16_t)(in_a[i] * 32767), x = (int16_t)(in_b[i] * 32767);
+        err = MAX(err, fabs(fast_atan2_q15(y, x) - atan2(y, x) * 8192.0));
+    }
+    FAST_BENCH(fast, sink_q = fast_atan2_q15((int16_t)(in_a[i] * 32767), (int16_t)(in_b[i] * 32767)));
+    shell_print(sh, "%-14s %8u %8s %11.2f lsb", "atan2_q15", fast, "-", err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        int32_t y = (int32_t)(in_a[i] * 2147483520.0f), x = (int32_t)(in_b[i] * 2147483520.0f);
+        err = MAX(err, fabs(fast_atan2_q31(y, x) - atan2(y, x) * 536870912.0));
+    }
+    FAST_BENCH(fast, sink_q = fast_atan2_q31((int32_t)(in_a[i] * 2147483520.0f),
+                                             (int32_t)(in_b[i] * 2147483520.0f)));
+    shell_print(sh, "%-14s %8u %8s %11.2f lsb", "atan2_q31", fast, "-", err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        int16_t x = (int16_t)(in_a[i] * 32767);
+        err = MAX(err, fabs(fast_asin_q15(x) - asin(x / 32768.0) * 8192.0));
+    }
+    FAST_BENCH(fast, sink_q = fast_asin_q15((int16_t)(in_a[i] * 32767)));
+    shell_print(sh, "%-14s %8u %8s %11.2f lsb", "asin_q15", fast, "-", err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        int32_t x = (int32_t)(in_a[i] * 2147483520.0f);
+        err = MAX(err, fabs(fast_asin_q31(x) - asin(x / 2147483648.0) * 536870912.0));
+    }
+    FAST_BENCH(fast, sink_q = fast_asin_q31((int32_t)(in_a[i] * 2147483520.0f)));
+    shell_print(sh, "%-14s %8u %8s %11.2f lsb", "asin_q31", fast, "-", err);
+
+    err = 0;
+    for (int i = 0; i < FAST_BENCH_N; i++) {
+        int32_t x = (int32_t)(fabsf(in_a[i]) * 2147483520.0f) + 1;
+        int16_t shift;
+        int32_t r = fast_rsqrt_q31(x, &shift);
+        err = MAX(err, fabs(ldexp(r / 2147483648.0, shift) * sqrt(x / 2147483648.0) - 1.0));
+    }
+    FAST_BENCH(fast, int16_t shift; sink_q = fast_rsqrt_q31((int32_t)(fabsf(in_a[i]) * 2147483520.0f) + 1, &shift));
+    shell_print(sh, "%-14s %8u %8s %11.2e rel", "rsqrt_q31", fast, "-", err);
+
+    timing_stop();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_fastmath,
+    SHELL_CMD(bench, NULL, "Cycles per call and max error of the kernels against libm", cmd_fastmath_bench),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(fastmath, &sub_fastmath, "Fast math kernels", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,121 @@
+/**
+ * @brief This is the fast_math.h header of the application. Polynomial and CORDIC approximations of atan2, asin and inverse square root.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file fast_math.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef FAST_MATH_H_
+#define FAST_MATH_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+
+// ------------------ Macros ------------------
+
+/*
+ * Fixed-point formats follow CMSIS-DSP: q15_t/q31_t inputs, angles returned in radians as
+ * Q2.13 (q15) or Q2.29 (q31). Errors below are the largest measured against double precision
+ * libm over a dense sweep of the whole input range, see the "fastmath bench" shell command.
+ */
+#define FAST_ATAN2F_MAX_ERR     2.0e-6f ///< fast_atan2f(), radians
+#define FAST_ASINF_MAX_ERR      7.5e-6f ///< fast_asinf(), radians
+#define FAST_RSQRTF_MAX_REL_ERR 5.0e-6f ///< fast_rsqrtf() and fast_sqrtf(), relative
+#define FAST_ATAN2_Q15_MAX_ERR  2       ///< fast_atan2_q15(), Q2.13 LSB (122 urad per LSB)
+#define FAST_ATAN2_Q31_MAX_ERR  5       ///< fast_atan2_q31(), Q2.29 LSB (1.9 nrad per LSB)
+#define FAST_ASIN_Q15_MAX_ERR   2       ///< fast_asin_q15(), Q2.13 LSB
+#define FAST_ASIN_Q31_MAX_ERR   5       ///< fast_asin_q31(), Q2.29 LSB
+#define FAST_RSQRT_Q31_MAX_REL_ERR 6.0e-8f  ///< fast_rsqrt_q31(), relative
+#define FAST_RSQRT_Q15_MAX_REL_ERR 3.1e-5f  ///< fast_rsqrt_q15(), relative, mantissa rounding
+
+#define FAST_PI_Q13     25736       ///< pi in Q2.13
+#define FAST_PI_Q29     1686629713  ///< pi in Q2.29
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Four-quadrant arctangent, 6th order minimax polynomial on the octant.
+ *
+ * @return float atan2(y, x) in [-pi, pi], 0 for (0, 0).
+ */
+float fast_atan2f(float y, float x);
+
+/**
+ * @brief Arcsine, pi/2 - sqrt(1 - |x|) * P(|x|) (Abramowitz & Stegun 4.4.46).
+ *
+ * @return float asin(x) in [-pi/2, pi/2], inputs outside [-1, 1] are clamped.
+ */
+float fast_asinf(float x);
+
+/**
+ * @brief Inverse square root, bit-level initial guess and two Newton steps.
+ *
+ * @return float 1/sqrt(x) for x > 0.
+ */
+float fast_rsqrtf(float x);
+
+/**
+ * @brief Square root through fast_rsqrtf(), same relative error.
+ *
+ * @return float sqrt(x), 0 for x <= 0.
+ */
+static inline float fast_sqrtf(float x)
+{
+    return (x > 0.0f) ? x * fast_rsqrtf(x) : 0.0f;
+}
+
+/**
+ * @brief Four-quadrant arctangent of q15 inputs, polynomial on the octant.
+ *
+ * @return int16_t atan2(y, x) in Q2.13 radians, 0 for (0, 0).
+ */
+int16_t fast_atan2_q15(int16_t y, int16_t x);
+
+/**
+ * @brief Four-quadrant arctangent of q31 inputs, 30-step CORDIC in vectoring mode.
+ *
+ * @return int32_t atan2(y, x) in Q2.29 radians, 0 for (0, 0).
+ */
+int32_t fast_atan2_q31(int32_t y, int32_t x);
+
+/**
+ * @brief Arcsine of a q15 value, atan2(x, sqrt(1 - x^2)) with an integer square root.
+ *
+ * @return int16_t asin(x) in Q2.13 radians.
+ */
+int16_t fast_asin_q15(int16_t x);
+
+/**
+ * @brief Arcsine of a q31 value, atan2(x, sqrt(1 - x^2)) with an integer square root.
+ *
+ * @return int32_t asin(x) in Q2.29 radians.
+ */
+int32_t fast_asin_q31(int32_t x);
+
+/**
+ * @brief Inverse square root of a positive q15 value, as mantissa and exponent.
+ *
+ * @param x Input, > 0.
+ * @param shift Set so that 1/sqrt(x) = result * 2^shift.
+ * @return int16_t Mantissa in q15, in [0.5, 1), -1 and shift 0 for x <= 0.
+ */
+int16_t fast_rsqrt_q15(int16_t x, int16_t *shift);
+
+/**
+ * @brief Inverse square root of a positive q31 value, as mantissa and exponent.
+ *
+ * Normalized by an even shift and refined by three Newton steps from a linear guess.
+ *
+ * @param x Input, > 0.
+ * @param shift Set so that 1/sqrt(x) = result * 2^shift.
+ * @return int32_t Mantissa in q31, in [0.5, 1), -1 and shift 0 for x <= 0.
+ */
+int32_t fast_rsqrt_q31(int32_t x, int16_t *shift);
+
+#endif /* FAST_MATH_H_ */
@@ -0,0 +1,73 @@
+/**
+ * @brief This is the fusion.c source code of the application. Complementary filter fusing accelerometer and gyroscope into roll/pitch.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file fusion.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include "fast_math.h"
+#include "fusion.h"
+
+// ------------------ Macros ------------------
+
+#define FUSION_DT_MAX   0.1f ///< Longer gaps are not integrated, s
+
+// ------------------ Functions ------------------
+
+void fusion_reset(struct fusion *f)
+{
+    f->roll = 0.0f;
+    f->pitch = 0.0f;
+    f->t_us = 0;
+    f->valid = false;
+}
+
+void fusion_update(struct fusion *f, const struct imu_sample *sample)
+{
+    float ax = sample->acc[0] * 1e-6f;
+    float ay = sample->acc[1] * 1e-6f;
+    float az = sample->acc[2] * 1e-6f;
+    float roll_acc = fast_atan2f(ay, az);
+    float pitch_acc = fast_atan2f(-ax, fast_sqrtf(ay * ay + az * az));
+
+    if (!f->valid) {
+        f->roll = roll_acc;
+        f->pitch = pitch_acc;
+        f->t_us = sample->t_us;
+        f->valid = true;
+        return;
+    }
+
+    float dt = (sample->t_us - f->t_us) * 1e-6f;
+
+    f->t_us = sample->t_us;
+    if (dt <= 0.0f || dt > FUSION_DT_MAX) {
+        f->roll = roll_acc;
+        f->pitch = pitch_acc;
+        return;
+    }
+
+    float alpha = CONFIG_FUSION_TAU_MS / (CONFIG_FUSION_TAU_MS + dt * 1000.0f);
+
+    f->roll = alpha * (f->roll + sample->gyr[0] * 1e-6f * dt) + (1.0f - alpha) * roll_acc;
+    f->pitch = alpha * (f->pitch + sample->gyr[1] * 1e-6f * dt) + (1.0f - alpha) * pitch_acc;
+}
+
+float fusion_predict(float angle, int32_t rate_urads, uint32_t horizon_us)
+{
+    float tau = CONFIG_FUSION_PREDICT_TAU_MS * 1e-3f;
+    float h = MIN(horizon_us, CONFIG_FUSION_PREDICT_MAX_MS * 1000U) * 1e-6f;
+
+    return angle + rate_urads * 1e-6f * tau * (1.0f - expf(-h / tau));
+}
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,68 @@
+/**
+ * @brief This is the fusion.h header of the application. Complementary filter fusing accelerometer and gyroscope into roll/pitch.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file fusion.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef FUSION_H_
+#define FUSION_H_
+
+// ------------------ Includes ------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "imu.h"
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Filter instance.
+ */
+struct fusion {
+    float roll;     ///< Rotation about X, rad
+    float pitch;    ///< Rotation about Y, rad
+    int64_t t_us;   ///< Timestamp of the last sample, microseconds
+    bool valid;     ///< roll/pitch hold an estimate
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Reset the filter, the next sample initializes it from the accelerometer alone.
+ *
+ * @param f Filter instance.
+ */
+void fusion_reset(struct fusion *f);
+
+/**
+ * @brief Add one sample: integrate the gyroscope and pull towards the accelerometer tilt.
+ *
+ * The accelerometer weight follows from CONFIG_FUSION_TAU_MS and the time since the previous
+ * sample, so the response does not depend on the sample rate.
+ *
+ * @param f Filter instance.
+ * @param sample Bias corrected, timestamped sample.
+ */
+void fusion_update(struct fusion *f, const struct imu_sample *sample);
+
+/**
+ * @brief Extrapolate an angle forward with its angular rate.
+ *
+ * The rate is assumed to decay with time constant CONFIG_FUSION_PREDICT_TAU_MS, so the angle
+ * moves by rate * tau * (1 - exp(-horizon / tau)): close to linear for short horizons, bounded
+ * by rate * tau for long ones, which keeps a stopping motion from overshooting.
+ *
+ * @param angle Angle at the sample time, rad.
+ * @param rate_urads Angular rate at the sample time, micro rad/s.
+ * @param horizon_us How far ahead to predict, microseconds, capped at CONFIG_FUSION_PREDICT_MAX_MS.
+ * @return float Predicted angle, rad.
+ */
+float fusion_predict(float angle, int32_t rate_urads, uint32_t horizon_us);
+
+#endif /* FUSION_H_ */
@@ -27,6 +27,7 @@
 #include <zephyr/pm/pm.h>
 #include <zephyr/pm/device.h>
 #include <zephyr/pm/policy.h>
+#include <zephyr/shell/shell.h>
 
 // --------------------------------- Defines ---------------------------------
 LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
@@ -94,6 +95,10 @@ LOG_MODULE_REGISTER(gc9a01, CONFIG_DISPLAY_LOG_LEVEL);
 #define DISPLAY_WIDTH         DT_INST_PROP(0, width)
 #define DISPLAY_HEIGHT        DT_INST_PROP(0, height)
 
+#define GC9A01_TILE           16 ///< Tile side of the shadow hashes, pixels
+#define GC9A01_TILES_X        (DISPLAY_WIDTH / GC9A01_TILE)
+#define GC9A01_TILES_Y        (DISPLAY_HEIGHT / GC9A01_TILE)
+
 // Command codes:
 #define COL_ADDR_SET        0x2A
 #define ROW_ADDR_SET        0x2B
@@ -190,6 +195,40 @@ struct gc9a01_frame {
 
 static struct gc9a01_frame frame = {{0, 0}, {DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1}};
 
+#ifdef CONFIG_GC9A01_FLUSH_SWAP
+/**
+ * @brief Rectangle of pixels in a buffer, consumed row by row.
+ */
+struct gc9a01_pixels {
+    const uint16_t *row;    ///< Current row
+    uint16_t width;         ///< Pixels per row
+    uint16_t pitch;         ///< Pixels from one row to the next in the buffer
+    uint16_t rows;          ///< Rows left, the current one included
+    uint16_t col;           ///< Pixels of the current row already taken
+};
+
+// byte swapped pixels, one chunk is swapped while the other is sent
+static uint16_t flush_chunk[2][CONFIG_GC9A01_FLUSH_CHUNK_SIZE / sizeof(uint16_t)] __aligned(4);
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+BUILD_ASSERT(DISPLAY_WIDTH % GC9A01_TILE == 0 && DISPLAY_HEIGHT % GC9A01_TILE == 0,
+             "the display must be a whole number of tiles");
+
+// hash of each tile last sent to GRAM, 0 if unknown
+static uint32_t tile_hash[GC9A01_TILES_Y][GC9A01_TILES_X];
+static struct {
+    uint32_t checked;   // tiles of tile-aligned writes hashed
+    uint32_t sent;      // tiles among them whose content changed
+    uint32_t unaligned; // writes not aligned to tiles, sent whole
+} tile_stats;
+#endif
+#ifdef CONFIG_SPI_ASYNC
+static struct k_poll_signal flush_done = K_POLL_SIGNAL_INITIALIZER(flush_done);
+static struct k_poll_event flush_event = K_POLL_EVENT_STATIC_INITIALIZER(K_POLL_TYPE_SIGNAL,
+                                                                         K_POLL_MODE_NOTIFY_ONLY,
+                                                                         &flush_done, 0);
+#endif
+#endif
+
 // --------------------------------- Functions ---------------------------------
 
 /**
@@ -226,6 +265,130 @@ static inline int gc9a01_write_cmd(const struct device *dev, uint8_t cmd,
     return 0;
 }
 
+#ifdef CONFIG_GC9A01_FLUSH_SWAP
+/**
+ * @brief Byte swap RGB565 pixels to the bus order, a word of two pixels at a time.
+ *
+ * The masked shifts compile to a single REV16 per word on Cortex-M.
+ *
+ * @param dst Swapped pixels.
+ * @param src Pixels in native order.
+ * @param count Number of pixels.
+ */
+static void gc9a01_swap16(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    const uint32_t *src32 = (const uint32_t *)src;
+    uint32_t *dst32 = (uint32_t *)dst;
+
+    for (size_t i = 0; i < count / 2; i++) {
+        uint32_t w = UNALIGNED_GET(&src32[i]);
+
+        UNALIGNED_PUT(((w & 0xFF00FF00) >> 8) | ((w & 0x00FF00FF) << 8), &dst32[i]);
+    }
+    if (count & 1) {
+        dst[count - 1] = __bswap_16(src[count - 1]);
+    }
+}
+
+/**
+ * @brief Swap the next pixels of a rectangle into a chunk, row by row.
+ *
+ * @param dst Chunk to fill.
+ * @param src Rectangle, advanced past the pixels taken.
+ * @param max Chunk size, pixels.
+ * @return size_t Pixels taken, 0 once the rectangle is done.
+ */
+static size_t gc9a01_gather(uint16_t *dst, struct gc9a01_pixels *src, size_t max)
+{
+    size_t n = 0;
+
+    while (n < max && src->rows > 0) {
+        size_t take = MIN((size_t)(src->width - src->col), max - n);
+
+        gc9a01_swap16(dst + n, src->row + src->col, take);
+        n += take;
+        src->col += take;
+        if (src->col == src->width) {
+            src->col = 0;
+            src->row += src->pitch;
+            src->rows--;
+        }
+    }
+    return n;
+}
+
+#ifdef CONFIG_SPI_ASYNC
+/**
+ * @brief Wait for the chunk in flight to be sent.
+ *
+ * @return int 0 if successful, negative errno code on failure.
+ */
+static int gc9a01_wait_chunk(void)
+{
+    unsigned int signaled;
+    int result;
+
+    k_poll(&flush_event, 1, K_FOREVER);
+    flush_event.state = K_POLL_STATE_NOT_READY;
+    k_poll_signal_check(&flush_done, &signaled, &result);
+    k_poll_signal_reset(&flush_done);
+    return result;
+}
+#endif
+
+/**
+ * @brief Write native RGB565 pixels to the frame set, byte swapped on the way.
+ *
+ * The pixels go out in CONFIG_GC9A01_FLUSH_CHUNK_SIZE chunks from two buffers: with
+ * CONFIG_SPI_ASYNC the next chunk is swapped while DMA sends the previous one.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param px Rectangle of pixels, native byte order.
+ * @return int 0 if successful, negative errno code on failure.
+ */
+static int gc9a01_write_pixels(const struct device *dev, struct gc9a01_pixels px)
+{
+    const struct gc9a01_config *config = dev->config;
+    const size_t chunk_px = ARRAY_SIZE(flush_chunk[0]);
+    struct spi_buf buf;
+    struct spi_buf_set buf_set = {.buffers = &buf, .count = 1};
+    int k = 0;
+
+    if (gc9a01_write_cmd(dev, GC9A01A_RAMWR, NULL, 0) != 0) {
+        return -EIO;
+    }
+    gpio_pin_set_dt(&config->dc_gpio, 1);
+
+    size_t n = gc9a01_gather(flush_chunk[k], &px, chunk_px);
+
+    while (n > 0) {
+        buf.buf = flush_chunk[k];
+        buf.len = n * sizeof(uint16_t);
+#ifdef CONFIG_SPI_ASYNC
+        if (spi_write_signal(config->bus.bus, &config->bus.config, &buf_set, &flush_done) != 0) {
+            LOG_ERR("Failed sending data");
+            return -EIO;
+        }
+#else
+        if (spi_write_dt(&config->bus, &buf_set) != 0) {
+            LOG_ERR("Failed sending data");
+            return -EIO;
+        }
+#endif
+        k ^= 1;
+        n = gc9a01_gather(flush_chunk[k], &px, chunk_px);
+#ifdef CONFIG_SPI_ASYNC
+        if (gc9a01_wait_chunk() != 0) {
+            LOG_ERR("Failed sending data");
+            return -EIO;
+        }
+#endif
+    }
+
+    return 0;
+}
+#endif
+
 /**
  * @brief Set the frame to write to.
  *
@@ -249,6 +412,110 @@ static void gc9a01_set_frame(const struct device *dev, struct gc9a01_frame frame
     gc9a01_write_cmd(dev, ROW_ADDR_SET, data, sizeof(data));
 }
 
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+/**
+ * @brief Hash of a tile, FNV-1a over its pixel words, never 0.
+ *
+ * @param px First pixel of the tile.
+ * @param pitch Pixels from one row to the next in the buffer.
+ * @return uint32_t Hash.
+ */
+static uint32_t gc9a01_tile_hash(const uint16_t *px, uint16_t pitch)
+{
+    uint32_t h = 2166136261u;
+
+    for (int r = 0; r < GC9A01_TILE; r++, px += pitch) {
+        const uint32_t *w = (const uint32_t *)px;
+
+        for (int i = 0; i < GC9A01_TILE / 2; i++) {
+            h = (h ^ UNALIGNED_GET(&w[i])) * 16777619u;
+        }
+    }
+    return h ? h : 1;
+}
+
+/**
+ * @brief Check if a write covers whole tiles only.
+ */
+static bool gc9a01_tiles_aligned(uint16_t x, uint16_t y, const struct display_buffer_descriptor *desc)
+{
+    return ((x | y | desc->width | desc->height) % GC9A01_TILE) == 0;
+}
+
+/**
+ * @brief Forget the hashes of the tiles a write touches, their GRAM content is now unknown.
+ */
+static void gc9a01_tiles_forget(uint16_t x, uint16_t y, const struct display_buffer_descriptor *desc)
+{
+    for (int ty = y / GC9A01_TILE; ty <= (y + desc->height - 1) / GC9A01_TILE; ty++) {
+        for (int tx = x / GC9A01_TILE; tx <= (x + desc->width - 1) / GC9A01_TILE; tx++) {
+            tile_hash[ty][tx] = 0;
+        }
+    }
+}
+
+/**
+ * @brief Send a rectangle of pixels as its own frame.
+ */
+static int gc9a01_write_area(const struct device *dev, uint16_t x, uint16_t y, struct gc9a01_pixels px)
+{
+    frame.start.X = x;
+    frame.end.X = x + px.width - 1;
+    frame.start.Y = y;
+    frame.end.Y = y + px.rows - 1;
+    gc9a01_set_frame(dev, frame);
+    return gc9a01_write_pixels(dev, px);
+}
+
+/**
+ * @brief Write a tile-aligned area, sending only the tiles whose content changed.
+ *
+ * Each run of changed tiles along a tile row is sent as one frame.
+ *
+ * @param dev Pointer to the device structure for the driver instance.
+ * @param x X coordinate to start writing to, a multiple of GC9A01_TILE.
+ * @param y Y coordinate to start writing to, a multiple of GC9A01_TILE.
+ * @param desc Buffer descriptor, a whole number of tiles.
+ * @param buf Pixels, native byte order.
+ * @return int 0 if successful, negative errno code on failure.
+ */
+static int gc9a01_write_tiles(const struct device *dev, uint16_t x, uint16_t y,
+                              const struct display_buffer_descriptor *desc, const uint16_t *buf)
+{
+    for (uint16_t ty = 0; ty < desc->height; ty += GC9A01_TILE) {
+        const uint16_t *row = buf + ty * desc->pitch;
+        uint32_t *hash = &tile_hash[(y + ty) / GC9A01_TILE][x / GC9A01_TILE];
+        int run = -1;
+
+        for (uint16_t tx = 0; tx <= desc->width; tx += GC9A01_TILE) {
+            bool changed = false;
+
+            if (tx < desc->width) {
+                uint32_t h = gc9a01_tile_hash(row + tx, desc->pitch);
+
+                changed = (h != hash[tx / GC9A01_TILE]);
+                hash[tx / GC9A01_TILE] = h;
+                tile_stats.checked++;
+            }
+            if (changed && run < 0) {
+                run = tx;
+            } else if (!changed && run >= 0) {
+                struct gc9a01_pixels px = {row + run, tx - run, desc->pitch, GC9A01_TILE, 0};
+
+                tile_stats.sent += (tx - run) / GC9A01_TILE;
+                if (gc9a01_write_area(dev, x + run, y + ty, px) != 0) {
+                    // unknown what reached GRAM
+                    gc9a01_tiles_forget(x, y, desc);
+                    return -EIO;
+                }
+                run = -1;
+            }
+        }
+    }
+    return 0;
+}
+#endif
+
 /**
  * @brief Turn off the display.
  *
@@ -292,6 +559,16 @@ static int gc9a01_write(const struct device *dev, const uint16_t x, const uint16
     uint32_t stop_time;
     uint32_t cycles_spent;
     uint32_t nanoseconds_spent;
+#endif
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+    if (gc9a01_tiles_aligned(x, y, desc)) {
+        int err = gc9a01_write_tiles(dev, x, y, desc, buf);
+
+        __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND) == 0, "Failed suspend SPI Bus");
+        return err;
+    }
+    gc9a01_tiles_forget(x, y, desc);
+    tile_stats.unaligned++;
 #endif
     uint16_t x_end_idx = x + desc->width - 1;
     uint16_t y_end_idx = y + desc->height - 1;
@@ -308,7 +585,11 @@ static int gc9a01_write(const struct device *dev, const uint16_t x, const uint16
 #ifdef GC9A01_SPI_PROFILING
     start_time = k_cycle_get_32();
 #endif
-    gc9a01_write_cmd(dev, GC9A01A_RAMWR, buf, len);
+#ifdef CONFIG_GC9A01_FLUSH_SWAP
+    int err = gc9a01_write_pixels(dev, (struct gc9a01_pixels){buf, desc->width, desc->pitch, desc->height, 0});
+#else
+    int err = gc9a01_write_cmd(dev, GC9A01A_RAMWR, buf, len);
+#endif
 #ifdef GC9A01_SPI_PROFILING
     stop_time = k_cycle_get_32();
     cycles_spent = stop_time - start_time;
@@ -316,7 +597,10 @@ static int gc9a01_write(const struct device *dev, const uint16_t x, const uint16
     LOG_DBG("%d =>: %dns", len, nanoseconds_spent);
 #endif
     __ASSERT(pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_SUSPEND) == 0, "Failed suspend SPI Bus");
-    return 0;
+    if (err < 0) {
+        LOG_ERR("Failed to write pixels: %d", err);
+    }
+    return err;
 }
 
 /**
@@ -442,6 +726,10 @@ static int gc9a01_controller_init(const struct device *dev)
     rc = pm_device_action_run(config->bus.bus, PM_DEVICE_ACTION_RESUME);
     __ASSERT(rc == -EALREADY || rc == 0, "Failed resume SPI Bus");
 
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+    // GRAM holds garbage after the reset
+    memset(tile_hash, 0, sizeof(tile_hash));
+#endif
     addr = initcmd;
     while ((cmd = *addr++) > 0) {
         x = *addr++;
@@ -559,6 +847,27 @@ static struct display_driver_api gc9a01_driver_api = {
     .set_orientation = gc9a01_set_orientation,
 };
 
+#if defined(CONFIG_GC9A01_TILE_SHADOW) && defined(CONFIG_SHELL)
+// --------------------------------- Shell Commands ---------------------------------
+static int cmd_gc9a01_tiles(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t skipped = tile_stats.checked - tile_stats.sent;
+
+    shell_print(sh, "tiles checked: %u, sent: %u, skipped: %u (%u%%), unaligned writes: %u",
+                tile_stats.checked, tile_stats.sent, skipped,
+                tile_stats.checked ? (uint32_t)((uint64_t)skipped * 100 / tile_stats.checked) : 0,
+                tile_stats.unaligned);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_gc9a01,
+    SHELL_CMD(tiles, NULL, "Tile shadow hit rate", cmd_gc9a01_tiles),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(gc9a01, &sub_gc9a01, "GC9A01 display driver", NULL);
+#endif
+
 PM_DEVICE_DT_INST_DEFINE(0, gc9a01_pm_action);
 DEVICE_DT_INST_DEFINE(0, gc9a01_init, PM_DEVICE_DT_INST_GET(0), NULL, &gc9a01_config, POST_KERNEL,
                       CONFIG_DISPLAY_INIT_PRIORITY, &gc9a01_driver_api);
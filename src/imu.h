@@ -0,0 +1,56 @@
+/**
+ * @brief This is the imu.h header of the application. Shared BMI270 configuration constants and sample types.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_H_
+#define IMU_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+
+// ------------------ Macros ------------------
+
+#define IMU_ACCEL_RANGE_G   2       ///< Accelerometer full scale, G
+#define IMU_GYRO_RANGE_DPS  500     ///< Gyroscope full scale, degrees/s
+#define IMU_ODR_HZ          100     ///< Accelerometer and gyroscope output data rate, Hz
+
+#define IMU_GRAVITY_UMS2    9806650 ///< Standard gravity, micro m/s^2
+
+#define IMU_ACCEL_RANGE_UMS2 ((int64_t)IMU_ACCEL_RANGE_G * IMU_GRAVITY_UMS2)       ///< Accelerometer full scale, micro m/s^2
+#define IMU_GYRO_RANGE_URADS ((int64_t)IMU_GYRO_RANGE_DPS * 17453293 / 1000)       ///< Gyroscope full scale, micro rad/s
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief One accelerometer + gyroscope reading in fixed-point SI units.
+ */
+struct imu_sample {
+    int32_t acc[3]; ///< Acceleration X/Y/Z, micro m/s^2
+    int32_t gyr[3]; ///< Angular rate X/Y/Z, micro rad/s
+    int64_t t_us;   ///< Data-ready time on the system clock, microseconds (see imu_time.h)
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Convert a sensor value to micro units.
+ *
+ * @param val Sensor value to convert.
+ * @return int32_t The value multiplied by 10^6.
+ */
+static inline int32_t imu_sensor_value_to_micro(const struct sensor_value *val)
+{
+    return val->val1 * 1000000 + val->val2;
+}
+
+#endif /* IMU_H_ */
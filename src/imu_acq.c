@@ -0,0 +1,129 @@
+/**
+ * @brief This is the imu_acq.c source code of the application. IMU acquisition thread publishing orientation frames.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_acq.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include "fusion.h"
+#include "imu_acq.h"
+#include "imu_calib.h"
+#include "imu_power.h"
+#include "imu_time.h"
+#include "orient_bus.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_acq, CONFIG_LOG_DEFAULT_LEVEL);
+
+// ------------------ Variables ------------------
+
+static K_SEM_DEFINE(acq_start, 0, 1);
+static K_TIMER_DEFINE(acq_timer, NULL, NULL);
+static atomic_t running;
+static K_MUTEX_DEFINE(period_lock); // held while a period reads the sensor, see imu_acq_stop()
+static struct fusion fusion;
+static struct imu_acq_stats stats;
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief One ODR period: read, correct, fuse and publish a sample.
+ *
+ * @param frame Frame to fill in and publish.
+ * @param last_t_us Timestamp of the last published sample, updated.
+ */
+static void imu_acq_period(struct orient_frame *frame, int64_t *last_t_us)
+{
+    if (imu_time_read(&frame->sample) < 0) {
+        stats.errors++;
+        return;
+    }
+    // the timer and the sensor clocks drift apart, a period may see the same sample twice
+    if (frame->sample.t_us == *last_t_us) {
+        stats.repeats++;
+        return;
+    }
+    *last_t_us = frame->sample.t_us;
+
+    imu_calib_apply(&frame->sample);
+    fusion_update(&fusion, &frame->sample);
+    frame->roll = fusion.roll;
+    frame->pitch = fusion.pitch;
+
+    orient_bus_publish(frame);
+    stats.published++;
+}
+
+/**
+ * @brief Acquisition thread: one burst read per ODR period while running.
+ */
+static void imu_acq_thread(void *p1, void *p2, void *p3)
+{
+    struct orient_frame frame;
+    int64_t last_t_us = INT64_MIN;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (true) {
+        k_sem_take(&acq_start, K_FOREVER);
+        k_timer_start(&acq_timer, K_USEC(1000000 / IMU_ODR_HZ), K_USEC(1000000 / IMU_ODR_HZ));
+
+        while (atomic_get(&running)) {
+            k_timer_status_sync(&acq_timer);
+
+            k_mutex_lock(&period_lock, K_FOREVER);
+            if (atomic_get(&running)) {
+                imu_acq_period(&frame, &last_t_us);
+            }
+            k_mutex_unlock(&period_lock);
+        }
+
+        k_timer_stop(&acq_timer);
+    }
+}
+
+K_THREAD_DEFINE(imu_acq_tid, CONFIG_IMU_ACQ_STACK_SIZE, imu_acq_thread, NULL, NULL, NULL,
+                CONFIG_IMU_ACQ_THREAD_PRIORITY, 0, 0);
+
+int imu_acq_start(void)
+{
+    // the sensor is only at full ODR in a session of an initialized power policy
+    if (imu_power_get_mode() != IMU_POWER_ACTIVE) {
+        LOG_ERR("IMU not active, not sampling");
+        return -ENODEV;
+    }
+    if (atomic_set(&running, 1) == 0) {
+        fusion_reset(&fusion);
+        k_sem_give(&acq_start);
+    }
+    return 0;
+}
+
+void imu_acq_stop(void)
+{
+    atomic_set(&running, 0);
+
+    // wait for the period in progress, the sensor and the offsets are free once this returns
+    k_mutex_lock(&period_lock, K_FOREVER);
+    k_mutex_unlock(&period_lock);
+}
+
+void imu_acq_get_stats(struct imu_acq_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------------ End of File ------------------------
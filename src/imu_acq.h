@@ -0,0 +1,57 @@
+/**
+ * @brief This is the imu_acq.h header of the application. IMU acquisition thread publishing orientation frames.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_acq.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_ACQ_H_
+#define IMU_ACQ_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Acquisition statistics.
+ */
+struct imu_acq_stats {
+    uint32_t published; ///< Frames published
+    uint32_t repeats;   ///< Reads that returned the previous sample again
+    uint32_t errors;    ///< Failed reads
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Start sampling at IMU_ODR_HZ: read, correct, fuse and publish on orient_chan.
+ *
+ * The sensor must be at full ODR, see imu_power_session().
+ *
+ * @return int 0 on success, -ENODEV if the sensor is not at full ODR.
+ */
+int imu_acq_start(void);
+
+/**
+ * @brief Stop sampling and wait for the period in progress.
+ *
+ * Once this returns the thread no longer touches the sensor bus or the bias offsets, so the
+ * sensor can be reconfigured and the offsets saved. Not from an ISR.
+ */
+void imu_acq_stop(void);
+
+/**
+ * @brief Get the acquisition statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_acq_get_stats(struct imu_acq_stats *stats);
+
+#endif /* IMU_ACQ_H_ */
@@ -0,0 +1,293 @@
+/**
+ * @brief This is the imu_calib.c source code of the application. Online BMI270 bias estimation with persistent storage.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_calib.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include "imu_calib.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_calib, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define IMU_CALIB_VERSION           1
+#define IMU_CALIB_KEY               "imu/calib"
+
+#define IMU_CALIB_EMA_WEIGHT        (1 << CONFIG_IMU_CALIB_EMA_SHIFT) ///< Maximum estimator weight, samples
+#define IMU_CALIB_GYRO_STILL_URADS  100000  ///< Max angular rate of a still sample, micro rad/s (~5.7 dps)
+#define IMU_CALIB_ACCEL_STILL_UMS2  500000  ///< Max deviation of |a| from 1 g of a still sample, micro m/s^2
+
+// ------------------ Variables ------------------
+
+// written by the tracker and the warm-up, read by the acquisition thread on every sample
+static struct k_spinlock calib_lock;
+static struct imu_calib_data calib = {
+    .version = IMU_CALIB_VERSION,
+    .temp_c100 = IMU_CALIB_TEMP_UNKNOWN,
+};
+// estimate in fixed point, bias << IMU_CALIB_EMA_SHIFT, so residuals below the weight still move it
+static int64_t gyr_bias_fx[3];
+static int64_t acc_bias_fx[3];
+static uint32_t weight;      // number of samples the current estimate is worth, saturates at IMU_CALIB_EMA_WEIGHT
+static uint32_t unsaved;     // still samples used since the last save
+static bool loaded;          // offsets were restored from flash
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Convert a fixed-point estimate to the offset applied, rounded to nearest.
+ *
+ * @param fx Estimate scaled by IMU_CALIB_EMA_WEIGHT.
+ * @return int32_t Offset in the unit of the sample.
+ */
+static inline int32_t imu_calib_from_fx(int64_t fx)
+{
+    return (int32_t)((fx + IMU_CALIB_EMA_WEIGHT / 2) >> CONFIG_IMU_CALIB_EMA_SHIFT);
+}
+
+/**
+ * @brief Load the fixed-point estimate from the applied offsets. Caller holds calib_lock.
+ */
+static void imu_calib_to_fx(void)
+{
+    for (int i = 0; i < 3; i++) {
+        gyr_bias_fx[i] = (int64_t)calib.gyr_bias[i] * IMU_CALIB_EMA_WEIGHT;
+        acc_bias_fx[i] = (int64_t)calib.acc_bias[i] * IMU_CALIB_EMA_WEIGHT;
+    }
+}
+
+/**
+ * @brief Step of the estimate towards a residual, res / weight in fixed point, rounded to nearest.
+ *
+ * @param res Residual bias of the sample.
+ * @return int64_t Step scaled by IMU_CALIB_EMA_WEIGHT, exactly res once the weight saturated.
+ */
+static inline int64_t imu_calib_step_fx(int32_t res)
+{
+    int64_t num = (int64_t)res * IMU_CALIB_EMA_WEIGHT;
+    int64_t half = weight / 2;
+
+    return (num >= 0 ? num + half : num - half) / (int64_t)weight;
+}
+
+/**
+ * @brief Read the BMI270 die temperature.
+ *
+ * @param sensor_dev Pointer to the sensor device structure.
+ * @return int16_t Temperature in 0.01 degC, or IMU_CALIB_TEMP_UNKNOWN if the driver does not provide it.
+ */
+static int16_t imu_calib_read_temp(const struct device *sensor_dev)
+{
+    struct sensor_value temp;
+
+    if (sensor_sample_fetch(sensor_dev) < 0 ||
+        sensor_channel_get(sensor_dev, SENSOR_CHAN_DIE_TEMP, &temp) < 0) {
+        return IMU_CALIB_TEMP_UNKNOWN;
+    }
+
+    return (int16_t)(temp.val1 * 100 + temp.val2 / 10000);
+}
+
+#ifdef CONFIG_IMU_CALIB_PERSIST
+/**
+ * @brief Settings handler restoring the "imu/calib" key.
+ *
+ * @param key Key name relative to the "imu" subtree.
+ * @param len Length of the stored value.
+ * @param read_cb Callback reading the stored value.
+ * @param cb_arg Argument of read_cb.
+ * @return int 0 on success, negative error code on failure.
+ */
+static int imu_calib_settings_set(const char *key, size_t len,
+                                  settings_read_cb read_cb, void *cb_arg)
+{
+    struct imu_calib_data stored;
+    const char *next;
+    ssize_t rc;
+
+    if (!settings_name_steq(key, "calib", &next) || next) {
+        return -ENOENT;
+    }
+
+    if (len != sizeof(stored)) {
+        return -EINVAL;
+    }
+
+    rc = read_cb(cb_arg, &stored, sizeof(stored));
+    if (rc < 0) {
+        return rc;
+    }
+
+    if (stored.version != IMU_CALIB_VERSION) {
+        LOG_WRN("Ignoring calibration with layout version %u", stored.version);
+        return 0;
+    }
+
+    k_spinlock_key_t lock_key = k_spin_lock(&calib_lock);
+
+    calib = stored;
+    imu_calib_to_fx();
+    loaded = true;
+    k_spin_unlock(&calib_lock, lock_key);
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(imu_calib, "imu", NULL, imu_calib_settings_set, NULL, NULL);
+#endif
+
+int imu_calib_init(const struct device *sensor_dev)
+{
+    int16_t temp = imu_calib_read_temp(sensor_dev);
+    k_spinlock_key_t key;
+
+#ifdef CONFIG_IMU_CALIB_PERSIST
+    int err = settings_subsys_init();
+    if (err) {
+        LOG_ERR("Failed to initialize settings: %d", err);
+        return err;
+    }
+
+    err = settings_load_subtree("imu");
+    if (err) {
+        LOG_ERR("Failed to load calibration: %d", err);
+        return err;
+    }
+#endif
+
+    if (!loaded) {
+        LOG_INF("No stored IMU calibration, estimating while still");
+        key = k_spin_lock(&calib_lock);
+        calib.temp_c100 = temp;
+        imu_calib_to_fx();
+        weight = 0;
+        k_spin_unlock(&calib_lock, key);
+        return 0;
+    }
+
+    LOG_INF("IMU calibration loaded, gyro bias %d %d %d urad/s, accel bias %d %d %d um/s^2",
+            calib.gyr_bias[0], calib.gyr_bias[1], calib.gyr_bias[2],
+            calib.acc_bias[0], calib.acc_bias[1], calib.acc_bias[2]);
+
+    // Offsets drift with temperature: keep them as a starting point, but let the
+    // estimator move away quickly when they were taken far from the current temperature.
+    bool stale = temp != IMU_CALIB_TEMP_UNKNOWN && calib.temp_c100 != IMU_CALIB_TEMP_UNKNOWN &&
+                 abs(temp - calib.temp_c100) > CONFIG_IMU_CALIB_TEMP_TOLERANCE * 100;
+
+    if (stale) {
+        LOG_WRN("Calibration taken at %d.%02d degC, now %d.%02d degC",
+                calib.temp_c100 / 100, abs(calib.temp_c100 % 100), temp / 100, abs(temp % 100));
+    }
+    key = k_spin_lock(&calib_lock);
+    weight = stale ? 0 : IMU_CALIB_EMA_WEIGHT;
+    calib.temp_c100 = temp;
+    k_spin_unlock(&calib_lock, key);
+
+    return 0;
+}
+
+void imu_calib_apply(struct imu_sample *sample)
+{
+    k_spinlock_key_t key = k_spin_lock(&calib_lock);
+
+    // all six offsets of the same update
+    for (int i = 0; i < 3; i++) {
+        sample->acc[i] -= calib.acc_bias[i];
+        sample->gyr[i] -= calib.gyr_bias[i];
+    }
+    k_spin_unlock(&calib_lock, key);
+}
+
+bool imu_calib_update(const struct imu_sample *sample)
+{
+    float gyr_norm = sqrtf((float)sample->gyr[0] * sample->gyr[0] +
+                           (float)sample->gyr[1] * sample->gyr[1] +
+                           (float)sample->gyr[2] * sample->gyr[2]);
+    float acc_norm = sqrtf((float)sample->acc[0] * sample->acc[0] +
+                           (float)sample->acc[1] * sample->acc[1] +
+                           (float)sample->acc[2] * sample->acc[2]);
+    float acc_err = acc_norm - IMU_GRAVITY_UMS2;
+
+    if (gyr_norm > IMU_CALIB_GYRO_STILL_URADS || fabsf(acc_err) > IMU_CALIB_ACCEL_STILL_UMS2) {
+        return false;
+    }
+
+    // Running mean for the first samples, exponential moving average afterwards. The sample is
+    // already corrected, so it is the residual bias: at rest the gyro reads zero and the
+    // accelerometer reads exactly 1 g along the measured gravity direction.
+    int32_t acc_res[3];
+
+    for (int i = 0; i < 3; i++) {
+        acc_res[i] = (int32_t)(acc_err * sample->acc[i] / acc_norm);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&calib_lock);
+
+    if (weight < IMU_CALIB_EMA_WEIGHT) {
+        weight++;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        gyr_bias_fx[i] += imu_calib_step_fx(sample->gyr[i]);
+        acc_bias_fx[i] += imu_calib_step_fx(acc_res[i]);
+        calib.gyr_bias[i] = imu_calib_from_fx(gyr_bias_fx[i]);
+        calib.acc_bias[i] = imu_calib_from_fx(acc_bias_fx[i]);
+    }
+    unsaved++;
+    k_spin_unlock(&calib_lock, key);
+
+    return true;
+}
+
+int imu_calib_save(void)
+{
+    struct imu_calib_data data;
+    uint32_t used;
+    k_spinlock_key_t key = k_spin_lock(&calib_lock);
+
+    // the flash write cannot hold the lock, a consistent copy is saved
+    data = calib;
+    used = unsaved;
+    k_spin_unlock(&calib_lock, key);
+
+    if (used < CONFIG_IMU_CALIB_MIN_SAMPLES) {
+        return 0;
+    }
+
+#ifdef CONFIG_IMU_CALIB_PERSIST
+    int err = settings_save_one(IMU_CALIB_KEY, &data, sizeof(data));
+    if (err) {
+        LOG_ERR("Failed to save calibration: %d", err);
+        return err;
+    }
+    LOG_INF("IMU calibration saved (%u still samples)", used);
+#endif
+
+    key = k_spin_lock(&calib_lock);
+    unsaved -= used;
+    k_spin_unlock(&calib_lock, key);
+    return 0;
+}
+
+void imu_calib_get(struct imu_calib_data *data)
+{
+    k_spinlock_key_t key = k_spin_lock(&calib_lock);
+
+    *data = calib;
+    k_spin_unlock(&calib_lock, key);
+}
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,84 @@
+/**
+ * @brief This is the imu_calib.h header of the application. Online BMI270 bias estimation with persistent storage.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_calib.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_CALIB_H_
+#define IMU_CALIB_H_
+
+// ------------------ Includes ------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include "imu.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_CALIB_TEMP_UNKNOWN INT16_MIN ///< Temperature tag value when the die temperature is not available
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Bias offsets as stored in flash under the "imu/calib" settings key.
+ */
+struct imu_calib_data {
+    uint16_t version;    ///< Layout version of this structure
+    int16_t temp_c100;   ///< Die temperature when estimated, 0.01 degC, or IMU_CALIB_TEMP_UNKNOWN
+    int32_t gyr_bias[3]; ///< Gyroscope bias X/Y/Z, micro rad/s
+    int32_t acc_bias[3]; ///< Accelerometer bias X/Y/Z, micro m/s^2
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Load the persisted bias offsets and tag them with the current die temperature.
+ *
+ * Must be called after the sensor is configured. If no offsets are stored, or they were
+ * estimated at a temperature too far from the current one, the estimator starts from its
+ * fast-converging initial state.
+ *
+ * @param sensor_dev Pointer to the sensor device structure.
+ * @return int 0 on success, negative error code on failure.
+ */
+int imu_calib_init(const struct device *sensor_dev);
+
+/**
+ * @brief Subtract the current bias offsets from a sample.
+ *
+ * @param sample Sample to correct in place.
+ */
+void imu_calib_apply(struct imu_sample *sample);
+
+/**
+ * @brief Refine the bias offsets with a corrected sample taken while the device is held still.
+ *
+ * Samples which are not stationary (rotation or non-gravity acceleration) are rejected.
+ *
+ * @param sample Sample already corrected by imu_calib_apply().
+ * @return true if the sample was used to refine the offsets.
+ */
+bool imu_calib_update(const struct imu_sample *sample);
+
+/**
+ * @brief Persist the bias offsets if they were refined enough since the last save.
+ *
+ * @return int 0 on success or if there was nothing to save, negative error code on failure.
+ */
+int imu_calib_save(void);
+
+/**
+ * @brief Get the bias offsets currently applied.
+ *
+ * @param data Pointer to the offsets to fill in.
+ */
+void imu_calib_get(struct imu_calib_data *data);
+
+#endif /* IMU_CALIB_H_ */
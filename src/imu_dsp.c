@@ -0,0 +1,473 @@
+/**
+ * @brief This is the imu_dsp.c source code of the application. Block-based filter and decimation chain for the IMU stream.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_dsp.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/timing/timing.h>
+#include <arm_math.h>
+#include "imu_dsp.h"
+#include "imu_num.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_dsp, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define IMU_DSP_CHANNELS    6 ///< Accel X/Y/Z, gyro X/Y/Z
+#define IMU_DSP_STAGES      MAX(CONFIG_IMU_DSP_BIQUAD_STAGES, 1)
+#define IMU_DSP_CHECK_LEN   ((300 / CONFIG_IMU_DSP_BLOCK_SIZE) * CONFIG_IMU_DSP_BLOCK_SIZE) ///< imu_dsp_check() samples
+
+/*
+ * Per-backend CMSIS-DSP kernels. The fixed-point biquads are direct form I with a post-shift of
+ * one, so coefficients are stored halved and |a1| up to 2 still fits; q15 stages carry an extra
+ * zero after b0 for the SIMD kernel.
+ */
+#if defined(CONFIG_IMU_NUM_Q15)
+typedef arm_biquad_casd_df1_inst_q15 imu_dsp_biquad_t;
+typedef arm_fir_decimate_instance_q15 imu_dsp_fir_t;
+#define IMU_DSP_BIQUAD_COEFFS   6
+#define IMU_DSP_BIQUAD_STATE    4
+#define IMU_DSP_BIQUAD_SHIFT    1
+#elif defined(CONFIG_IMU_NUM_Q31)
+typedef arm_biquad_casd_df1_inst_q31 imu_dsp_biquad_t;
+typedef arm_fir_decimate_instance_q31 imu_dsp_fir_t;
+#define IMU_DSP_BIQUAD_COEFFS   5
+#define IMU_DSP_BIQUAD_STATE    4
+#define IMU_DSP_BIQUAD_SHIFT    1
+#else
+typedef arm_biquad_cascade_df2T_instance_f32 imu_dsp_biquad_t;
+typedef arm_fir_decimate_instance_f32 imu_dsp_fir_t;
+#define IMU_DSP_BIQUAD_COEFFS   5
+#define IMU_DSP_BIQUAD_STATE    2
+#define IMU_DSP_BIQUAD_SHIFT    0
+#endif
+
+BUILD_ASSERT(CONFIG_IMU_DSP_BLOCK_SIZE % CONFIG_IMU_DSP_DECIMATION == 0,
+             "Block size must be a multiple of the decimation factor");
+BUILD_ASSERT(IS_ENABLED(CONFIG_IMU_NUM_F32) || (IMU_ACCEL_RANGE_UMS2 <= IMU_NUM_FULL_SCALE_U &&
+             IMU_GYRO_RANGE_URADS <= IMU_NUM_FULL_SCALE_U),
+             "IMU full scale exceeds the fixed-point range");
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief State of the chain for one channel.
+ */
+struct imu_dsp_chan {
+    imu_dsp_biquad_t biquad;
+    imu_dsp_fir_t fir;
+    imu_num_t biquad_state[IMU_DSP_BIQUAD_STATE * IMU_DSP_STAGES];
+    imu_num_t fir_state[CONFIG_IMU_DSP_FIR_TAPS + CONFIG_IMU_DSP_BLOCK_SIZE - 1];
+    imu_num_t median_hist[2];
+};
+
+// ------------------ Variables ------------------
+
+// designed in float, converted to the backend format
+static float biquad_design[5 * IMU_DSP_STAGES];
+static float fir_design[CONFIG_IMU_DSP_FIR_TAPS];
+static imu_num_t biquad_coeffs[IMU_DSP_BIQUAD_COEFFS * IMU_DSP_STAGES];
+static imu_num_t fir_coeffs[CONFIG_IMU_DSP_FIR_TAPS];
+
+static struct imu_dsp_chan chan[IMU_DSP_CHANNELS];
+static imu_num_t block_in[IMU_DSP_CHANNELS][CONFIG_IMU_DSP_BLOCK_SIZE];
+static int64_t block_t[CONFIG_IMU_DSP_BLOCK_SIZE];
+static imu_num_t block_tmp[CONFIG_IMU_DSP_BLOCK_SIZE];
+static imu_num_t block_out[IMU_DSP_OUT_MAX];
+static uint32_t fill;
+static bool designed;
+static struct imu_dsp_stats stats;
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Design a Butterworth low-pass as a cascade of biquads (bilinear transform).
+ *
+ * Coefficients are stored in CMSIS-DSP order {b0, b1, b2, -a1, -a2} per stage.
+ */
+static void imu_dsp_design_biquads(float fc, float fs, int stages)
+{
+    float k = tanf(PI * fc / fs);
+
+    for (int s = 0; s < stages; s++) {
+        float q = 1.0f / (2.0f * cosf(PI * (2 * s + 1) / (4.0f * stages)));
+        float norm = 1.0f / (1.0f + k / q + k * k);
+        float *c = &biquad_design[5 * s];
+
+        c[0] = k * k * norm;
+        c[1] = 2.0f * c[0];
+        c[2] = c[0];
+        c[3] = -2.0f * (k * k - 1.0f) * norm;
+        c[4] = -(1.0f - k / q + k * k) * norm;
+    }
+}
+
+/**
+ * @brief Design the anti-alias FIR: Hamming-windowed sinc at 80% of the output Nyquist rate.
+ */
+static void imu_dsp_design_fir(int taps, int decimation)
+{
+    float fc = 0.8f * 0.5f / decimation; // normalized to the input rate
+    float sum = 0.0f;
+
+    for (int n = 0; n < taps; n++) {
+        float m = n - (taps - 1) / 2.0f;
+        float sinc = (m == 0.0f) ? 2.0f * fc : sinf(2.0f * PI * fc * m) / (PI * m);
+        float window = (taps > 1) ? 0.54f - 0.46f * cosf(2.0f * PI * n / (taps - 1)) : 1.0f;
+
+        fir_design[n] = sinc * window;
+        sum += fir_design[n];
+    }
+
+    for (int n = 0; n < taps; n++) {
+        fir_design[n] /= sum; // unity gain at DC
+    }
+}
+
+/**
+ * @brief Convert the designed coefficients to the backend format and layout.
+ */
+static void imu_dsp_convert_coeffs(void)
+{
+    for (int s = 0; s < IMU_DSP_STAGES; s++) {
+        const float *d = &biquad_design[5 * s];
+        imu_num_t *c = &biquad_coeffs[IMU_DSP_BIQUAD_COEFFS * s];
+        int k = 0;
+
+        for (int i = 0; i < 5; i++) {
+            c[k++] = imu_num_from_frac(d[i] / (1 << IMU_DSP_BIQUAD_SHIFT));
+            if (i == 0 && IMU_DSP_BIQUAD_COEFFS == 6) {
+                c[k++] = 0;
+            }
+        }
+    }
+
+    for (int n = 0; n < CONFIG_IMU_DSP_FIR_TAPS; n++) {
+        fir_coeffs[n] = imu_num_from_frac(fir_design[n]);
+    }
+}
+
+static inline imu_num_t median3(imu_num_t a, imu_num_t b, imu_num_t c)
+{
+    return MAX(MIN(a, b), MIN(MAX(a, b), c));
+}
+
+/**
+ * @brief Reset one channel and bind it to the shared coefficients.
+ */
+static int imu_dsp_chan_init(struct imu_dsp_chan *ch)
+{
+    int ret;
+
+    memset(ch, 0, sizeof(*ch));
+#if defined(CONFIG_IMU_NUM_Q15)
+    arm_biquad_cascade_df1_init_q15(&ch->biquad, IMU_DSP_STAGES, biquad_coeffs, ch->biquad_state,
+                                    IMU_DSP_BIQUAD_SHIFT);
+    ret = arm_fir_decimate_init_q15(&ch->fir, CONFIG_IMU_DSP_FIR_TAPS, CONFIG_IMU_DSP_DECIMATION,
+                                    fir_coeffs, ch->fir_state, CONFIG_IMU_DSP_BLOCK_SIZE);
+#elif defined(CONFIG_IMU_NUM_Q31)
+    arm_biquad_cascade_df1_init_q31(&ch->biquad, IMU_DSP_STAGES, biquad_coeffs, ch->biquad_state,
+                                    IMU_DSP_BIQUAD_SHIFT);
+    ret = arm_fir_decimate_init_q31(&ch->fir, CONFIG_IMU_DSP_FIR_TAPS, CONFIG_IMU_DSP_DECIMATION,
+                                    fir_coeffs, ch->fir_state, CONFIG_IMU_DSP_BLOCK_SIZE);
+#else
+    arm_biquad_cascade_df2T_init_f32(&ch->biquad, IMU_DSP_STAGES, biquad_coeffs, ch->biquad_state);
+    ret = arm_fir_decimate_init_f32(&ch->fir, CONFIG_IMU_DSP_FIR_TAPS, CONFIG_IMU_DSP_DECIMATION,
+                                    fir_coeffs, ch->fir_state, CONFIG_IMU_DSP_BLOCK_SIZE);
+#endif
+    return (ret == ARM_MATH_SUCCESS) ? 0 : -EINVAL;
+}
+
+/**
+ * @brief Run one block of one channel through median, biquads and decimator.
+ *
+ * @param src Block of CONFIG_IMU_DSP_BLOCK_SIZE inputs, may be overwritten.
+ * @param tmp Scratch block of CONFIG_IMU_DSP_BLOCK_SIZE.
+ * @param out IMU_DSP_OUT_MAX decimated outputs.
+ */
+static void imu_dsp_chan_run(struct imu_dsp_chan *ch, imu_num_t *src, imu_num_t *tmp,
+                             imu_num_t *out)
+{
+    if (IS_ENABLED(CONFIG_IMU_DSP_MEDIAN)) {
+        // 3-tap median, carrying the last two inputs over from the previous block
+        imu_num_t prev2 = ch->median_hist[0];
+        imu_num_t prev1 = ch->median_hist[1];
+
+        for (int n = 0; n < CONFIG_IMU_DSP_BLOCK_SIZE; n++) {
+            imu_num_t x = src[n];
+
+            tmp[n] = median3(prev2, prev1, x);
+            prev2 = prev1;
+            prev1 = x;
+        }
+        ch->median_hist[0] = prev2;
+        ch->median_hist[1] = prev1;
+        src = tmp;
+    }
+
+    if (CONFIG_IMU_DSP_BIQUAD_STAGES > 0) {
+#if defined(CONFIG_IMU_NUM_Q15)
+        arm_biquad_cascade_df1_q15(&ch->biquad, src, tmp, CONFIG_IMU_DSP_BLOCK_SIZE);
+#elif defined(CONFIG_IMU_NUM_Q31)
+        arm_biquad_cascade_df1_q31(&ch->biquad, src, tmp, CONFIG_IMU_DSP_BLOCK_SIZE);
+#else
+        arm_biquad_cascade_df2T_f32(&ch->biquad, src, tmp, CONFIG_IMU_DSP_BLOCK_SIZE);
+#endif
+        src = tmp;
+    }
+
+#if defined(CONFIG_IMU_NUM_Q15)
+    arm_fir_decimate_q15(&ch->fir, src, out, CONFIG_IMU_DSP_BLOCK_SIZE);
+#elif defined(CONFIG_IMU_NUM_Q31)
+    arm_fir_decimate_q31(&ch->fir, src, out, CONFIG_IMU_DSP_BLOCK_SIZE);
+#else
+    arm_fir_decimate_f32(&ch->fir, src, out, CONFIG_IMU_DSP_BLOCK_SIZE);
+#endif
+}
+
+int imu_dsp_init(void)
+{
+    imu_dsp_design_biquads(CONFIG_IMU_DSP_LPF_HZ, IMU_ODR_HZ, IMU_DSP_STAGES);
+    imu_dsp_design_fir(CONFIG_IMU_DSP_FIR_TAPS, CONFIG_IMU_DSP_DECIMATION);
+    imu_dsp_convert_coeffs();
+    designed = true;
+
+    for (int c = 0; c < IMU_DSP_CHANNELS; c++) {
+        if (imu_dsp_chan_init(&chan[c]) != 0) {
+            LOG_ERR("Invalid FIR decimator configuration");
+            return -EINVAL;
+        }
+    }
+
+    fill = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    timing_init();
+    timing_start();
+
+    LOG_INF("IMU filter chain: %d Hz -> %d Hz, block %d, %s", IMU_ODR_HZ,
+            IMU_ODR_HZ / CONFIG_IMU_DSP_DECIMATION, CONFIG_IMU_DSP_BLOCK_SIZE, IMU_NUM_NAME);
+    return 0;
+}
+
+int imu_dsp_push(const struct imu_sample *in, struct imu_sample *out)
+{
+    for (int i = 0; i < 3; i++) {
+        block_in[i][fill] = imu_num_from_micro(in->acc[i]);
+        block_in[3 + i][fill] = imu_num_from_micro(in->gyr[i]);
+    }
+    block_t[fill] = in->t_us;
+
+    if (++fill < CONFIG_IMU_DSP_BLOCK_SIZE) {
+        return 0;
+    }
+    fill = 0;
+
+    timing_t start = timing_counter_get();
+
+    for (int c = 0; c < IMU_DSP_CHANNELS; c++) {
+        imu_dsp_chan_run(&chan[c], block_in[c], block_tmp, block_out);
+
+        for (int n = 0; n < IMU_DSP_OUT_MAX; n++) {
+            int32_t v = imu_num_to_micro(block_out[n]);
+
+            if (c < 3) {
+                out[n].acc[c] = v;
+            } else {
+                out[n].gyr[c - 3] = v;
+            }
+        }
+    }
+
+    // each output takes the timestamp of the last input it decimates
+    for (int n = 0; n < IMU_DSP_OUT_MAX; n++) {
+        out[n].t_us = block_t[(n + 1) * CONFIG_IMU_DSP_DECIMATION - 1];
+    }
+
+    timing_t end = timing_counter_get();
+    uint32_t cycles = (uint32_t)timing_cycles_get(&start, &end);
+
+    stats.blocks++;
+    stats.cycles_last = cycles;
+    stats.cycles_max = MAX(stats.cycles_max, cycles);
+    stats.cycles_total += cycles;
+
+    return IMU_DSP_OUT_MAX;
+}
+
+void imu_dsp_get_stats(struct imu_dsp_stats *out)
+{
+    *out = stats;
+}
+
+/**
+ * @brief Test signal of imu_dsp_check(): 0.5 g at 1 Hz, 0.2 g at 20 Hz and +/-0.1 m/s^2 noise.
+ */
+static void imu_dsp_check_signal(int32_t *in, int len)
+{
+    uint32_t seed = 1;
+
+    for (int n = 0; n < len; n++) {
+        float t = (float)n / IMU_ODR_HZ;
+
+        seed = seed * 1103515245 + 12345;
+        in[n] = (int32_t)(0.5f * IMU_GRAVITY_UMS2 * sinf(2.0f * PI * t) +
+                          0.2f * IMU_GRAVITY_UMS2 * sinf(2.0f * PI * 20.0f * t)) +
+                (int32_t)((seed >> 8) % 200001) - 100000;
+    }
+}
+
+/**
+ * @brief Double precision reference of one channel, sample by sample from the float design.
+ *
+ * @return int Number of decimated outputs.
+ */
+static int imu_dsp_reference(const int32_t *in, int len, double *out)
+{
+    double med[2] = {0};
+    double z[IMU_DSP_STAGES][4] = {0}; // x[n-1], x[n-2], y[n-1], y[n-2]
+    double hist[CONFIG_IMU_DSP_FIR_TAPS] = {0};
+    int n_out = 0;
+
+    for (int n = 0; n < len; n++) {
+        double x = in[n];
+
+        if (IS_ENABLED(CONFIG_IMU_DSP_MEDIAN)) {
+            double m = MAX(MIN(med[0], med[1]), MIN(MAX(med[0], med[1]), x));
+
+            med[0] = med[1];
+            med[1] = x;
+            x = m;
+        }
+
+        for (int s = 0; s < CONFIG_IMU_DSP_BIQUAD_STAGES; s++) {
+            const float *c = &biquad_design[5 * s];
+            double y = c[0] * x + c[1] * z[s][0] + c[2] * z[s][1] + c[3] * z[s][2] + c[4] * z[s][3];
+
+            z[s][1] = z[s][0];
+            z[s][0] = x;
+            z[s][3] = z[s][2];
+            z[s][2] = y;
+            x = y;
+        }
+
+        memmove(&hist[1], &hist[0], (CONFIG_IMU_DSP_FIR_TAPS - 1) * sizeof(hist[0]));
+        hist[0] = x;
+        if ((n + 1) % CONFIG_IMU_DSP_DECIMATION == 0) {
+            double acc = 0.0;
+
+            for (int k = 0; k < CONFIG_IMU_DSP_FIR_TAPS; k++) {
+                acc += fir_design[k] * hist[k];
+            }
+            out[n_out++] = acc;
+        }
+    }
+    return n_out;
+}
+
+int imu_dsp_check(struct imu_dsp_check_result *result)
+{
+    // one caller at a time, a separate channel so the running chain is not disturbed
+    static struct imu_dsp_chan check;
+    static int32_t in[IMU_DSP_CHECK_LEN];
+    static double ref[IMU_DSP_CHECK_LEN / CONFIG_IMU_DSP_DECIMATION];
+    imu_num_t blk[CONFIG_IMU_DSP_BLOCK_SIZE];
+    imu_num_t tmp[CONFIG_IMU_DSP_BLOCK_SIZE];
+    imu_num_t out[IMU_DSP_OUT_MAX];
+    double err_max = 0.0;
+    double err_sq = 0.0;
+    uint32_t cycles_max = 0;
+    int k = 0;
+
+    if (!designed) {
+        return -EAGAIN;
+    }
+    if (imu_dsp_chan_init(&check) != 0) {
+        return -EINVAL;
+    }
+
+    imu_dsp_check_signal(in, IMU_DSP_CHECK_LEN);
+    imu_dsp_reference(in, IMU_DSP_CHECK_LEN, ref);
+
+    for (int b = 0; b < IMU_DSP_CHECK_LEN / CONFIG_IMU_DSP_BLOCK_SIZE; b++) {
+        for (int n = 0; n < CONFIG_IMU_DSP_BLOCK_SIZE; n++) {
+            blk[n] = imu_num_from_micro(in[b * CONFIG_IMU_DSP_BLOCK_SIZE + n]);
+        }
+
+        timing_t start = timing_counter_get();
+
+        imu_dsp_chan_run(&check, blk, tmp, out);
+
+        timing_t end = timing_counter_get();
+
+        cycles_max = MAX(cycles_max, (uint32_t)timing_cycles_get(&start, &end));
+
+        for (int n = 0; n < IMU_DSP_OUT_MAX; n++, k++) {
+            double e = fabs(imu_num_to_micro(out[n]) - ref[k]);
+
+            err_max = MAX(err_max, e);
+            err_sq += e * e;
+        }
+    }
+
+    result->outputs = k;
+    result->err_max = (uint32_t)err_max;
+    result->err_rms = (uint32_t)sqrt(err_sq / k);
+    result->cycles_max = cycles_max;
+    return 0;
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_dsp_check(const struct shell *sh, size_t argc, char **argv)
+{
+    struct imu_dsp_check_result r;
+    int ret = imu_dsp_check(&r);
+
+    if (ret == -EAGAIN) {
+        shell_error(sh, "Filter chain not initialized");
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    shell_print(sh, "backend: %s, outputs: %u, cycles/block/channel max: %u", IMU_NUM_NAME,
+                r.outputs, r.cycles_max);
+    shell_print(sh, "error vs double reference: max %u, rms %u (micro m/s^2)", r.err_max,
+                r.err_rms);
+    return 0;
+}
+
+static int cmd_dsp_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    struct imu_dsp_stats s = stats;
+
+    shell_print(sh, "backend: %s, blocks: %u, cycles/block last: %u, max: %u, avg: %u",
+                IMU_NUM_NAME, s.blocks, s.cycles_last, s.cycles_max,
+                s.blocks ? (uint32_t)(s.cycles_total / s.blocks) : 0);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_dsp,
+    SHELL_CMD(stats, NULL, "Filter chain cycle counts", cmd_dsp_stats),
+    SHELL_CMD(check, NULL, "Accuracy of the numeric backend against a double reference", cmd_dsp_check),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(dsp, &sub_dsp, "IMU filter chain", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
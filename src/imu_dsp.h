@@ -0,0 +1,87 @@
+/**
+ * @brief This is the imu_dsp.h header of the application. Block-based filter and decimation chain for the IMU stream.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_dsp.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_DSP_H_
+#define IMU_DSP_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include "imu.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_DSP_OUT_MAX (CONFIG_IMU_DSP_BLOCK_SIZE / CONFIG_IMU_DSP_DECIMATION) ///< Outputs per processed block
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Filter chain statistics, cycles are CPU cycles per processed block.
+ */
+struct imu_dsp_stats {
+    uint32_t blocks;       ///< Processed blocks
+    uint32_t cycles_last;  ///< Cycles of the last block
+    uint32_t cycles_max;   ///< Worst-case cycles of a block
+    uint64_t cycles_total; ///< Cycles of all blocks
+};
+
+/**
+ * @brief Accuracy of the numeric backend against the double precision reference.
+ */
+struct imu_dsp_check_result {
+    uint32_t outputs;    ///< Decimated outputs compared
+    uint32_t err_max;    ///< Largest error, micro m/s^2
+    uint32_t err_rms;    ///< RMS error, micro m/s^2
+    uint32_t cycles_max; ///< Worst-case cycles of one block of one channel
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Design the filters and reset the chain state.
+ *
+ * The chain runs per channel at IMU_ODR_HZ: optional 3-tap median, Butterworth low-pass
+ * biquad cascade, then an anti-alias FIR decimating by CONFIG_IMU_DSP_DECIMATION, in the
+ * number format selected by CONFIG_IMU_NUM (see imu_num.h).
+ *
+ * @return int 0 on success, negative error code on failure.
+ */
+int imu_dsp_init(void);
+
+/**
+ * @brief Queue one sample, and run the chain when a block is complete.
+ *
+ * @param in Sample at the sensor rate.
+ * @param out Array of IMU_DSP_OUT_MAX decimated samples, oldest first.
+ * @return int Number of samples written to out, 0 until a block is complete.
+ */
+int imu_dsp_push(const struct imu_sample *in, struct imu_sample *out);
+
+/**
+ * @brief Get the filter chain statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_dsp_get_stats(struct imu_dsp_stats *stats);
+
+/**
+ * @brief Run a test signal through a separate channel of the chain and compare it with a
+ * double precision reference of the same design.
+ *
+ * The signal is 0.5 g at 1 Hz, 0.2 g at 20 Hz and +/-0.1 m/s^2 of noise. Not reentrant.
+ *
+ * @param result Pointer to the result to fill in.
+ * @return int 0 on success, -EAGAIN before imu_dsp_init(), -EINVAL on a bad configuration.
+ */
+int imu_dsp_check(struct imu_dsp_check_result *result);
+
+#endif /* IMU_DSP_H_ */
@@ -0,0 +1,93 @@
+/**
+ * @brief This is the imu_num.h header of the application. Numeric backend of the IMU pipeline, q15, q31 or float32.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_num.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_NUM_H_
+#define IMU_NUM_H_
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+// ------------------ Macros ------------------
+
+/*
+ * Samples enter and leave the pipeline in micro SI units (struct imu_sample). The fixed-point
+ * backends map +/-IMU_NUM_FULL_SCALE_U micro units to +/-1.0, a power of two so conversions
+ * are plain shifts: q15 has 1024 micro units per LSB, q31 1/64 micro unit per LSB.
+ */
+#define IMU_NUM_FULL_SCALE_U    (1 << 25)   ///< About 33.5 m/s^2 or rad/s at 1.0
+
+#if defined(CONFIG_IMU_NUM_Q15)
+#define IMU_NUM_NAME    "q15"
+#elif defined(CONFIG_IMU_NUM_Q31)
+#define IMU_NUM_NAME    "q31"
+#else
+#define IMU_NUM_NAME    "f32"
+#endif
+
+// ------------------ Typedefs ------------------
+
+#if defined(CONFIG_IMU_NUM_Q15)
+typedef int16_t imu_num_t;  ///< q15_t
+#elif defined(CONFIG_IMU_NUM_Q31)
+typedef int32_t imu_num_t;  ///< q31_t
+#else
+typedef float imu_num_t;    ///< float32_t, SI units
+#endif
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Convert a signal value from micro SI units, saturating at the full scale.
+ */
+static inline imu_num_t imu_num_from_micro(int32_t v)
+{
+#if defined(CONFIG_IMU_NUM_Q15)
+    return (imu_num_t)CLAMP((v + (1 << 9)) >> 10, INT16_MIN, INT16_MAX);
+#elif defined(CONFIG_IMU_NUM_Q31)
+    return (imu_num_t)CLAMP((int64_t)v << 6, INT32_MIN, INT32_MAX);
+#else
+    return v * 1e-6f;
+#endif
+}
+
+/**
+ * @brief Convert a signal value back to micro SI units.
+ */
+static inline int32_t imu_num_to_micro(imu_num_t v)
+{
+#if defined(CONFIG_IMU_NUM_Q15)
+    return (int32_t)v << 10;
+#elif defined(CONFIG_IMU_NUM_Q31)
+    return (int32_t)(((int64_t)v + (1 << 5)) >> 6);
+#else
+    return (int32_t)(v * 1e6f);
+#endif
+}
+
+/**
+ * @brief Convert a coefficient in [-1, 1), saturating. Used when filters are designed, not per sample.
+ */
+static inline imu_num_t imu_num_from_frac(float f)
+{
+#if defined(CONFIG_IMU_NUM_Q15)
+    return (imu_num_t)CLAMP(lroundf(f * 32768.0f), INT16_MIN, INT16_MAX);
+#elif defined(CONFIG_IMU_NUM_Q31)
+    return (imu_num_t)CLAMP(llround(f * 2147483648.0), INT32_MIN, INT32_MAX);
+#else
+    return f;
+#endif
+}
+
+#endif /* IMU_NUM_H_ */
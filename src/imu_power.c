@@ -0,0 +1,309 @@
+/**
+ * @brief This is the imu_power.c source code of the application. Motion-adaptive BMI270 power and ODR policy.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_power.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include "imu.h"
+#include "imu_power.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_power, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define IMU_POWER_MOTION_TH_UMS2    (CONFIG_IMU_POWER_MOTION_TH_MMS2 * 1000)
+
+// ------------------ Variables ------------------
+
+static const struct device *imu_dev;
+static K_MUTEX_DEFINE(power_lock);
+
+static enum imu_power_mode mode = IMU_POWER_SUSPEND;
+static int64_t mode_since;      // uptime of the last mode change, ms
+static bool ready;              // imu_power_init() succeeded, the sensor can be configured
+static bool session;            // a measurement session is running
+static bool motion;             // the device is being moved
+static struct imu_power_stats stats;
+
+static void imu_power_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(power_work, imu_power_work_handler);
+
+#ifndef CONFIG_BMI270_TRIGGER
+static int32_t ref[3];          // previous accelerometer sample, micro m/s^2
+static bool ref_valid;
+static bool fetch_failed;       // the last poll could not read the sensor
+static uint8_t motion_count;    // consecutive samples above the slope threshold
+static int64_t still_since;     // uptime the slope last exceeded the threshold, ms
+#endif
+
+static const char *const mode_names[IMU_POWER_MODES] = {"suspend", "idle", "active"};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Set the sampling frequency of one sensor, which also selects its power mode.
+ */
+static int imu_power_set_odr(enum sensor_channel chan, int32_t odr_mhz)
+{
+    struct sensor_value odr = {
+        .val1 = odr_mhz / 1000,
+        .val2 = (odr_mhz % 1000) * 1000,
+    };
+
+    return sensor_attr_set(imu_dev, chan, SENSOR_ATTR_SAMPLING_FREQUENCY, &odr);
+}
+
+/**
+ * @brief Reconfigure the sensor for a mode, called with power_lock held.
+ */
+static int imu_power_apply(enum imu_power_mode next)
+{
+    int64_t now = k_uptime_get();
+    int ret;
+
+    if (next == mode) {
+        return 0;
+    }
+
+    // Both sensors go to 0 Hz first: other attributes may only change while not sampling
+    ret = imu_power_set_odr(SENSOR_CHAN_GYRO_XYZ, 0);
+    ret = ret ? ret : imu_power_set_odr(SENSOR_CHAN_ACCEL_XYZ, 0);
+
+    if (ret == 0 && next == IMU_POWER_IDLE) {
+        ret = imu_power_set_odr(SENSOR_CHAN_ACCEL_XYZ, CONFIG_IMU_POWER_IDLE_ODR_MHZ);
+    } else if (ret == 0 && next == IMU_POWER_ACTIVE) {
+        ret = imu_power_set_odr(SENSOR_CHAN_ACCEL_XYZ, IMU_ODR_HZ * 1000);
+        ret = ret ? ret : imu_power_set_odr(SENSOR_CHAN_GYRO_XYZ, IMU_ODR_HZ * 1000);
+    }
+
+    stats.time_ms[mode] += now - mode_since;
+    mode_since = now;
+
+    if (ret < 0) {
+        LOG_ERR("Failed to switch the IMU to %s mode: %d", mode_names[next], ret);
+        mode = IMU_POWER_SUSPEND; // sampling frequencies are unknown, start over next time
+        return ret;
+    }
+
+    LOG_INF("IMU %s -> %s", mode_names[mode], mode_names[next]);
+    mode = next;
+    stats.switches++;
+    return 0;
+}
+
+/**
+ * @brief Pick the mode from the session and motion state, called with power_lock held.
+ */
+static int imu_power_evaluate(void)
+{
+    return imu_power_apply((session || motion) ? IMU_POWER_ACTIVE : IMU_POWER_IDLE);
+}
+
+#ifdef CONFIG_BMI270_TRIGGER
+static void imu_power_trigger_handler(const struct device *dev, const struct sensor_trigger *trig)
+{
+    ARG_UNUSED(dev);
+
+    if (trig->type == SENSOR_TRIG_MOTION && !motion) {
+        stats.motion_events++;
+    }
+    motion = (trig->type == SENSOR_TRIG_MOTION);
+    k_work_reschedule(&power_work, K_NO_WAIT);
+}
+
+static void imu_power_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    k_mutex_lock(&power_lock, K_FOREVER);
+    imu_power_evaluate();
+    k_mutex_unlock(&power_lock);
+}
+
+static int imu_power_detector_init(void)
+{
+    const struct sensor_trigger any_motion = {
+        .type = SENSOR_TRIG_MOTION,
+        .chan = SENSOR_CHAN_ACCEL_XYZ,
+    };
+    const struct sensor_trigger no_motion = {
+        .type = SENSOR_TRIG_STATIONARY,
+        .chan = SENSOR_CHAN_ACCEL_XYZ,
+    };
+    int ret = sensor_trigger_set(imu_dev, &any_motion, imu_power_trigger_handler);
+
+    return ret ? ret : sensor_trigger_set(imu_dev, &no_motion, imu_power_trigger_handler);
+}
+#else
+/**
+ * @brief Any-motion / no-motion detection on the idle accelerometer stream.
+ *
+ * Mirrors the BMI270 features, whose interrupt line is not wired on this board: motion is
+ * CONFIG_IMU_POWER_MOTION_SAMPLES consecutive samples whose slope exceeds the threshold on any
+ * axis, and it ends after CONFIG_IMU_POWER_NO_MOTION_MS without such a sample.
+ */
+static void imu_power_work_handler(struct k_work *work)
+{
+    struct sensor_value acc[3];
+    int64_t now = k_uptime_get();
+    int ret;
+
+    ARG_UNUSED(work);
+
+    k_mutex_lock(&power_lock, K_FOREVER);
+
+    // the acquisition loop owns the sensor during a session
+    if (session) {
+        ref_valid = false;
+        k_mutex_unlock(&power_lock);
+        return;
+    }
+
+    // the BMI270 driver only fetches all channels at once, SENSOR_CHAN_ALL
+    ret = sensor_sample_fetch(imu_dev);
+    if (ret == 0) {
+        ret = sensor_channel_get(imu_dev, SENSOR_CHAN_ACCEL_XYZ, acc);
+    }
+    if (ret < 0) {
+        // logged once per run of failures, the poll would flood the log otherwise
+        if (!fetch_failed) {
+            LOG_WRN("Failed to read the idle accelerometer: %d", ret);
+        }
+        fetch_failed = true;
+        stats.fetch_errors++;
+        ref_valid = false;
+    } else {
+        int32_t slope = 0;
+
+        fetch_failed = false;
+        for (int i = 0; i < 3; i++) {
+            int32_t a = acc[i].val1 * 1000000 + acc[i].val2;
+
+            slope = MAX(slope, abs(a - ref[i]));
+            ref[i] = a;
+        }
+
+        if (ref_valid && slope > IMU_POWER_MOTION_TH_UMS2) {
+            motion_count = MIN(motion_count + 1, UINT8_MAX);
+            still_since = now;
+        } else {
+            motion_count = 0;
+        }
+        ref_valid = true;
+
+        if (!motion && motion_count >= CONFIG_IMU_POWER_MOTION_SAMPLES) {
+            motion = true;
+            stats.motion_events++;
+        } else if (motion && now - still_since >= CONFIG_IMU_POWER_NO_MOTION_MS) {
+            motion = false;
+        }
+        imu_power_evaluate();
+    }
+
+    k_mutex_unlock(&power_lock);
+    k_work_reschedule(&power_work, K_MSEC(CONFIG_IMU_POWER_POLL_MS));
+}
+
+static int imu_power_detector_init(void)
+{
+    ref_valid = false;
+    motion_count = 0;
+    k_work_reschedule(&power_work, K_MSEC(CONFIG_IMU_POWER_POLL_MS));
+    return 0;
+}
+#endif
+
+int imu_power_init(const struct device *sensor_dev)
+{
+    int ret;
+
+    imu_dev = sensor_dev;
+    mode_since = k_uptime_get();
+
+    k_mutex_lock(&power_lock, K_FOREVER);
+    ret = imu_power_apply(IMU_POWER_IDLE);
+    ready = (ret == 0);
+    k_mutex_unlock(&power_lock);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ret = imu_power_detector_init();
+    if (ret < 0) {
+        LOG_ERR("Failed to start IMU motion detection: %d", ret);
+    }
+    return ret;
+}
+
+int imu_power_session(bool active)
+{
+    k_mutex_lock(&power_lock, K_FOREVER);
+    if (!ready) {
+        k_mutex_unlock(&power_lock);
+        return -ENODEV;
+    }
+    int ret;
+
+    session = active;
+    motion = false;
+    ret = imu_power_evaluate();
+    k_mutex_unlock(&power_lock);
+
+#ifndef CONFIG_BMI270_TRIGGER
+    if (!active) {
+        k_work_reschedule(&power_work, K_MSEC(CONFIG_IMU_POWER_POLL_MS));
+    }
+#endif
+    return ret;
+}
+
+enum imu_power_mode imu_power_get_mode(void)
+{
+    return mode;
+}
+
+void imu_power_get_stats(struct imu_power_stats *out)
+{
+    k_mutex_lock(&power_lock, K_FOREVER);
+    *out = stats;
+    out->time_ms[mode] += k_uptime_get() - mode_since;
+    k_mutex_unlock(&power_lock);
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_imupower_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    struct imu_power_stats s;
+
+    imu_power_get_stats(&s);
+    shell_print(sh, "mode: %s, switches: %u, motion events: %u", mode_names[mode], s.switches,
+                s.motion_events);
+    for (int m = 0; m < IMU_POWER_MODES; m++) {
+        shell_print(sh, "%-8s %llu ms", mode_names[m], (unsigned long long)s.time_ms[m]);
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_imupower,
+    SHELL_CMD(stats, NULL, "Time spent in each sensor power mode", cmd_imupower_stats),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(imupower, &sub_imupower, "IMU power policy", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,83 @@
+/**
+ * @brief This is the imu_power.h header of the application. Motion-adaptive BMI270 power and ODR policy.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_power.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_POWER_H_
+#define IMU_POWER_H_
+
+// ------------------ Includes ------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Sensor power modes chosen by the policy.
+ */
+enum imu_power_mode {
+    IMU_POWER_SUSPEND, ///< Accelerometer and gyroscope off (before init)
+    IMU_POWER_IDLE,    ///< Accelerometer only, low-power mode at CONFIG_IMU_POWER_IDLE_ODR_MHZ
+    IMU_POWER_ACTIVE,  ///< Accelerometer and gyroscope at IMU_ODR_HZ, performance mode
+    IMU_POWER_MODES,
+};
+
+/**
+ * @brief Power policy statistics.
+ */
+struct imu_power_stats {
+    uint64_t time_ms[IMU_POWER_MODES]; ///< Time spent in each mode, milliseconds
+    uint32_t switches;                 ///< Sensor reconfigurations
+    uint32_t motion_events;            ///< Any-motion detections outside of a session
+    uint32_t fetch_errors;             ///< Failed idle accelerometer reads
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Put the sensor in idle mode and start motion detection.
+ *
+ * Full scale and oversampling must be configured before, the policy only owns the sampling
+ * frequencies (and with them the BMI270 power mode).
+ *
+ * @param sensor_dev Pointer to the sensor device structure.
+ * @return int 0 on success, negative error code on failure.
+ */
+int imu_power_init(const struct device *sensor_dev);
+
+/**
+ * @brief Tell the policy a measurement session starts or ends.
+ *
+ * The sensor is at full ODR for the whole session. The call returns once the sensor has been
+ * reconfigured.
+ *
+ * @param active True when a session starts, false when it ends.
+ * @return int 0 on success, -ENODEV if imu_power_init() did not succeed, negative error code
+ * if the sensor could not be reconfigured.
+ */
+int imu_power_session(bool active);
+
+/**
+ * @brief Get the current sensor power mode.
+ *
+ * @return enum imu_power_mode The current mode.
+ */
+enum imu_power_mode imu_power_get_mode(void);
+
+/**
+ * @brief Get the power policy statistics, the current mode included up to now.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_power_get_stats(struct imu_power_stats *stats);
+
+#endif /* IMU_POWER_H_ */
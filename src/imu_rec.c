@@ -0,0 +1,386 @@
+/**
+ * @brief This is the imu_rec.c source code of the application. Compact binary recording of the IMU sample stream.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_rec.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/zbus/zbus.h>
+#include "imu_rec.h"
+#include "orient_bus.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_REC_BLOCKS          (CONFIG_IMU_REC_BUF_SIZE / CONFIG_IMU_REC_BLOCK_SIZE)
+#define IMU_REC_PAYLOAD_NIBBLES ((CONFIG_IMU_REC_BLOCK_SIZE - sizeof(struct imu_rec_block_hdr)) * 2)
+#define IMU_REC_MAX_FRAME_NIBBLES (11 + 6 * 6) ///< 32-bit timestamp delta-of-delta + six 17-bit channel deltas
+
+BUILD_ASSERT(CONFIG_IMU_REC_BUF_SIZE % CONFIG_IMU_REC_BLOCK_SIZE == 0,
+             "Recording buffer must hold a whole number of blocks");
+BUILD_ASSERT(IMU_REC_PAYLOAD_NIBBLES >= IMU_REC_MAX_FRAME_NIBBLES && IMU_REC_PAYLOAD_NIBBLES <= UINT16_MAX,
+             "Recording block size out of range");
+
+// ------------------ Variables ------------------
+
+static uint8_t rec_buf[CONFIG_IMU_REC_BUF_SIZE] __aligned(4);
+
+static struct {
+    bool active;                 // session in progress
+    uint32_t block;              // index of the block being filled
+    uint16_t frames;             // frames in the block being filled
+    uint16_t nibbles;            // payload nibbles used in the block being filled
+    struct imu_rec_frame prev;   // previous frame, reference of the deltas
+    uint32_t prev_dt;            // previous timestamp delta, reference of the delta-of-delta
+    struct imu_rec_stats stats;
+} rec;
+static K_MUTEX_DEFINE(rec_lock); // the session is started and stopped from the UI, frames come from the subscriber
+
+ZBUS_SUBSCRIBER_DEFINE(imu_rec_sub, CONFIG_IMU_REC_SUB_QUEUE_SIZE);
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Divide rounding to nearest, for quantization.
+ */
+static int32_t imu_rec_div_round(int64_t num, int64_t den)
+{
+    int64_t q = (num >= 0 ? num + den / 2 : num - den / 2) / den;
+
+    return CLAMP(q, INT16_MIN, INT16_MAX);
+}
+
+static inline uint32_t zigzag_encode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+/**
+ * @brief Append a nibble varint to a nibble array.
+ *
+ * @return size_t Number of nibbles written.
+ */
+static size_t nibble_varint_put(uint8_t *out, uint32_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x8) {
+        out[n++] = (v & 0x7) | 0x8;
+        v >>= 3;
+    }
+    out[n++] = v;
+
+    return n;
+}
+
+/**
+ * @brief Read a nibble varint from a packed nibble stream.
+ *
+ * @param payload Packed nibbles, low nibble first.
+ * @param pos Position in nibbles, advanced past the varint.
+ * @param end Number of valid nibbles.
+ * @param v Decoded value.
+ * @return int 0 on success, -EBADMSG if the stream is truncated or the value too long.
+ */
+static int nibble_varint_get(const uint8_t *payload, uint32_t *pos, uint32_t end, uint32_t *v)
+{
+    uint32_t value = 0;
+
+    for (int shift = 0; shift < 33; shift += 3) {
+        if (*pos >= end) {
+            return -EBADMSG;
+        }
+        uint8_t nib = (payload[*pos / 2] >> ((*pos & 1) * 4)) & 0xF;
+        (*pos)++;
+        value |= (uint32_t)(nib & 0x7) << shift;
+        if (!(nib & 0x8)) {
+            *v = value;
+            return 0;
+        }
+    }
+
+    return -EBADMSG;
+}
+
+static inline struct imu_rec_block_hdr *imu_rec_block(uint32_t index)
+{
+    return (struct imu_rec_block_hdr *)&rec_buf[index * CONFIG_IMU_REC_BLOCK_SIZE];
+}
+
+static uint32_t imu_rec_block_crc(const struct imu_rec_block_hdr *hdr)
+{
+    const uint8_t *payload = (const uint8_t *)(hdr + 1);
+    uint32_t crc;
+
+    crc = crc32_ieee((const uint8_t *)hdr, offsetof(struct imu_rec_block_hdr, crc));
+    crc = crc32_ieee_update(crc, (const uint8_t *)&hdr->first, sizeof(hdr->first));
+    return crc32_ieee_update(crc, payload, (hdr->nibbles + 1) / 2);
+}
+
+/**
+ * @brief Start a new block with the frame stored verbatim in its header.
+ */
+static void imu_rec_open_block(const struct imu_rec_frame *frame)
+{
+    struct imu_rec_block_hdr *hdr = imu_rec_block(rec.block);
+
+    memset(hdr, 0, CONFIG_IMU_REC_BLOCK_SIZE);
+    hdr->first = *frame;
+    rec.frames = 1;
+    rec.nibbles = 0;
+    rec.prev = *frame;
+    rec.prev_dt = 0;
+}
+
+/**
+ * @brief Fill in the header of the block in progress and move to the next block.
+ */
+static void imu_rec_seal_block(void)
+{
+    struct imu_rec_block_hdr *hdr = imu_rec_block(rec.block);
+
+    hdr->magic = IMU_REC_MAGIC;
+    hdr->seq = (uint16_t)rec.block;
+    hdr->frames = rec.frames;
+    hdr->nibbles = rec.nibbles;
+    hdr->crc = imu_rec_block_crc(hdr);
+
+    rec.stats.blocks++;
+    rec.stats.bytes += CONFIG_IMU_REC_BLOCK_SIZE;
+    rec.block++;
+    rec.frames = 0;
+}
+
+void imu_rec_frame_from_sample(const struct imu_sample *sample, uint32_t t_us,
+                               struct imu_rec_frame *frame)
+{
+    frame->t_us = t_us;
+    for (int i = 0; i < 3; i++) {
+        frame->acc[i] = imu_rec_div_round((int64_t)sample->acc[i] * 32768, IMU_ACCEL_RANGE_UMS2);
+        frame->gyr[i] = imu_rec_div_round((int64_t)sample->gyr[i] * 32768, IMU_GYRO_RANGE_URADS);
+    }
+}
+
+void imu_rec_start(void)
+{
+    k_mutex_lock(&rec_lock, K_FOREVER);
+    memset(&rec, 0, sizeof(rec));
+    rec.active = true;
+    k_mutex_unlock(&rec_lock);
+}
+
+static int imu_rec_push_locked(const struct imu_rec_frame *frame)
+{
+    uint8_t nibs[IMU_REC_MAX_FRAME_NIBBLES];
+    size_t n = 0;
+
+    if (!rec.active) {
+        return -EPERM;
+    }
+
+    if (rec.block >= IMU_REC_BLOCKS) {
+        rec.stats.overflows++;
+        return -ENOMEM;
+    }
+
+    if (rec.frames == 0) {
+        imu_rec_open_block(frame);
+        rec.stats.frames++;
+        return 0;
+    }
+
+    uint32_t dt = frame->t_us - rec.prev.t_us;
+
+    n += nibble_varint_put(&nibs[n], zigzag_encode((int32_t)(dt - rec.prev_dt)));
+    for (int i = 0; i < 3; i++) {
+        n += nibble_varint_put(&nibs[n], zigzag_encode(frame->acc[i] - rec.prev.acc[i]));
+    }
+    for (int i = 0; i < 3; i++) {
+        n += nibble_varint_put(&nibs[n], zigzag_encode(frame->gyr[i] - rec.prev.gyr[i]));
+    }
+
+    if (rec.nibbles + n > IMU_REC_PAYLOAD_NIBBLES || rec.frames == UINT16_MAX) {
+        imu_rec_seal_block();
+        if (rec.block >= IMU_REC_BLOCKS) {
+            rec.stats.overflows++;
+            return -ENOMEM;
+        }
+        imu_rec_open_block(frame);
+        rec.stats.frames++;
+        return 0;
+    }
+
+    uint8_t *payload = (uint8_t *)(imu_rec_block(rec.block) + 1);
+
+    for (size_t i = 0; i < n; i++, rec.nibbles++) {
+        payload[rec.nibbles / 2] |= nibs[i] << ((rec.nibbles & 1) * 4);
+    }
+
+    rec.frames++;
+    rec.prev = *frame;
+    rec.prev_dt = dt;
+    rec.stats.frames++;
+    return 0;
+}
+
+int imu_rec_push(const struct imu_rec_frame *frame)
+{
+    k_mutex_lock(&rec_lock, K_FOREVER);
+    int ret = imu_rec_push_locked(frame);
+    k_mutex_unlock(&rec_lock);
+
+    return ret;
+}
+
+void imu_rec_stop(void)
+{
+    k_mutex_lock(&rec_lock, K_FOREVER);
+    if (rec.active && rec.frames > 0 && rec.block < IMU_REC_BLOCKS) {
+        imu_rec_seal_block();
+    }
+    rec.active = false;
+    k_mutex_unlock(&rec_lock);
+}
+
+size_t imu_rec_get(const uint8_t **data)
+{
+    *data = rec_buf;
+    return rec.stats.bytes;
+}
+
+void imu_rec_get_stats(struct imu_rec_stats *stats)
+{
+    *stats = rec.stats;
+}
+
+int imu_rec_decode_block(const uint8_t *block, struct imu_rec_frame *frames, size_t max_frames)
+{
+    const struct imu_rec_block_hdr *hdr = (const struct imu_rec_block_hdr *)block;
+    const uint8_t *payload = (const uint8_t *)(hdr + 1);
+    struct imu_rec_frame cur;
+    uint32_t pos = 0;
+    uint32_t dt = 0;
+    uint32_t v;
+
+    if (hdr->magic != IMU_REC_MAGIC || hdr->frames == 0 || hdr->nibbles > IMU_REC_PAYLOAD_NIBBLES ||
+        hdr->crc != imu_rec_block_crc(hdr)) {
+        return -EBADMSG;
+    }
+
+    if (hdr->frames > max_frames) {
+        return -ENOSPC;
+    }
+
+    cur = hdr->first;
+    frames[0] = cur;
+
+    for (uint16_t f = 1; f < hdr->frames; f++) {
+        if (nibble_varint_get(payload, &pos, hdr->nibbles, &v)) {
+            return -EBADMSG;
+        }
+        dt += (uint32_t)zigzag_decode(v);
+        cur.t_us += dt;
+        for (int i = 0; i < 3; i++) {
+            if (nibble_varint_get(payload, &pos, hdr->nibbles, &v)) {
+                return -EBADMSG;
+            }
+            cur.acc[i] += zigzag_decode(v);
+        }
+        for (int i = 0; i < 3; i++) {
+            if (nibble_varint_get(payload, &pos, hdr->nibbles, &v)) {
+                return -EBADMSG;
+            }
+            cur.gyr[i] += zigzag_decode(v);
+        }
+        frames[f] = cur;
+    }
+
+    return hdr->frames;
+}
+
+// ------------------ Subscriber ------------------
+
+/**
+ * @brief Recorder thread: woken by orient_chan, records every frame while a session is active.
+ */
+static void imu_rec_thread(void *p1, void *p2, void *p3)
+{
+    static struct orient_reader reader;
+    const struct zbus_channel *chan;
+    struct orient_frame frame;
+    struct imu_rec_frame rec_frame;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    orient_bus_reader_init(&reader, "rec");
+
+    while (zbus_sub_wait(&imu_rec_sub, &chan, K_FOREVER) == 0) {
+        while (orient_bus_read(&reader, &frame) == 0) {
+            imu_rec_frame_from_sample(&frame.sample, (uint32_t)frame.sample.t_us, &rec_frame);
+            imu_rec_push(&rec_frame);
+        }
+    }
+}
+
+K_THREAD_DEFINE(imu_rec_tid, CONFIG_IMU_REC_STACK_SIZE, imu_rec_thread, NULL, NULL, NULL,
+                CONFIG_IMU_REC_THREAD_PRIORITY, 0, 0);
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_rec_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t raw = rec.stats.frames * sizeof(struct imu_rec_frame);
+
+    shell_print(sh, "frames: %u, blocks: %u, bytes: %u, overflows: %u",
+                rec.stats.frames, rec.stats.blocks, rec.stats.bytes, rec.stats.overflows);
+    if (rec.stats.bytes) {
+        shell_print(sh, "raw frames: %u bytes, ratio x%u.%02u", raw,
+                    raw / rec.stats.bytes, (raw % rec.stats.bytes) * 100 / rec.stats.bytes);
+    }
+    return 0;
+}
+
+static int cmd_rec_dump(const struct shell *sh, size_t argc, char **argv)
+{
+    const uint8_t *data;
+    size_t len = imu_rec_get(&data);
+    char line[2 * 32 + 1];
+
+    for (size_t off = 0; off < len; off += 32) {
+        for (size_t i = 0; i < 32; i++) {
+            snprintf(&line[2 * i], 3, "%02x", data[off + i]);
+        }
+        shell_print(sh, "%s", line);
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_rec,
+    SHELL_CMD(stats, NULL, "Recorder statistics", cmd_rec_stats),
+    SHELL_CMD(dump, NULL, "Hex dump of the last session, see scripts/imu_rec_decode.py", cmd_rec_dump),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(rec, &sub_rec, "IMU session recorder", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
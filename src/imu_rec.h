@@ -0,0 +1,134 @@
+/**
+ * @brief This is the imu_rec.h header of the application. Compact binary recording of the IMU sample stream.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_rec.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page imu_rec_page Session Recording Format
+ * @brief The recording is a sequence of fixed-size blocks of CONFIG_IMU_REC_BLOCK_SIZE bytes.
+ *
+ * Every block starts with a struct imu_rec_block_hdr holding the first frame verbatim, so
+ * each block decodes on its own. The following frames are stored as a stream of nibble
+ * varints (3 data bits + 1 continuation bit, least significant group first, low nibble of
+ * each byte first): the zig-zag encoded delta-of-delta of the timestamp, then the zig-zag
+ * encoded deltas of accel X/Y/Z and gyro X/Y/Z against the previous frame. The CRC-32 (IEEE)
+ * covers the header except the crc field itself, followed by the used payload bytes. Unused
+ * payload bytes are zero. scripts/imu_rec_decode.py decodes a recording on the host.
+ */
+
+#ifndef IMU_REC_H_
+#define IMU_REC_H_
+
+// ------------------ Includes ------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include "imu.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_REC_MAGIC 0x5249 ///< "IR", first bytes of every block
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief One recorded frame in BMI270 register units.
+ */
+struct imu_rec_frame {
+    uint32_t t_us;   ///< Timestamp, microseconds (wraps)
+    int16_t acc[3];  ///< Acceleration X/Y/Z, LSB of the IMU_ACCEL_RANGE_G range
+    int16_t gyr[3];  ///< Angular rate X/Y/Z, LSB of the IMU_GYRO_RANGE_DPS range
+} __attribute__((packed));
+
+/**
+ * @brief Header at the start of every recording block (little endian).
+ */
+struct imu_rec_block_hdr {
+    uint16_t magic;              ///< IMU_REC_MAGIC
+    uint16_t seq;                ///< Block sequence number within the session
+    uint16_t frames;             ///< Frames in the block, including the first one
+    uint16_t nibbles;            ///< Used payload length, nibbles
+    uint32_t crc;                ///< CRC-32 of the rest of the header and the used payload
+    struct imu_rec_frame first;  ///< First frame of the block
+} __attribute__((packed));
+
+/** Most frames a block can hold: the first one plus 7 single-nibble varints per frame */
+#define IMU_REC_BLOCK_FRAMES_MAX \
+    (1 + (CONFIG_IMU_REC_BLOCK_SIZE - sizeof(struct imu_rec_block_hdr)) * 2 / 7)
+
+/**
+ * @brief Recorder statistics.
+ */
+struct imu_rec_stats {
+    uint32_t frames;    ///< Frames recorded in the session
+    uint32_t blocks;    ///< Sealed blocks
+    uint32_t bytes;     ///< Bytes used by sealed blocks
+    uint32_t overflows; ///< Frames dropped because the buffer was full
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Quantize a sample to BMI270 register units.
+ *
+ * @param sample Sample in micro SI units.
+ * @param t_us Timestamp of the sample, microseconds.
+ * @param frame Pointer to the frame to fill in.
+ */
+void imu_rec_frame_from_sample(const struct imu_sample *sample, uint32_t t_us,
+                               struct imu_rec_frame *frame);
+
+/**
+ * @brief Discard any previous recording and start a new session.
+ *
+ * While the session is active, every frame published on orient_chan is recorded by the
+ * recorder subscriber thread.
+ */
+void imu_rec_start(void);
+
+/**
+ * @brief Encode one frame into the session. Constant worst-case cost per frame.
+ *
+ * @param frame Frame to record.
+ * @return int 0 on success, -ENOMEM if the recording buffer is full, -EPERM if not recording.
+ */
+int imu_rec_push(const struct imu_rec_frame *frame);
+
+/**
+ * @brief Seal the block in progress and stop the session.
+ */
+void imu_rec_stop(void);
+
+/**
+ * @brief Get the sealed blocks of the last session.
+ *
+ * @param data Set to the first block.
+ * @return size_t Number of bytes, a multiple of CONFIG_IMU_REC_BLOCK_SIZE.
+ */
+size_t imu_rec_get(const uint8_t **data);
+
+/**
+ * @brief Get the recorder statistics of the current or last session.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_rec_get_stats(struct imu_rec_stats *stats);
+
+/**
+ * @brief Decode one recording block.
+ *
+ * @param block Block of CONFIG_IMU_REC_BLOCK_SIZE bytes.
+ * @param frames Array to store the decoded frames in.
+ * @param max_frames Size of the frames array.
+ * @return int Number of decoded frames, -EBADMSG if the block is corrupt, -ENOSPC if frames is too small.
+ */
+int imu_rec_decode_block(const uint8_t *block, struct imu_rec_frame *frames, size_t max_frames);
+
+#endif /* IMU_REC_H_ */
@@ -0,0 +1,211 @@
+/**
+ * @brief This is the imu_time.c source code of the application. BMI270 sensor-time based sample timestamps.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_time.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include "imu_time.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_time, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define IMU_NODE                DT_COMPAT_GET_ANY_STATUS_OKAY(bosch_bmi270)
+
+#define BMI270_REG_ACC_X_LSB    0x0C ///< First data register, followed by gyro and SENSORTIME
+#define BMI270_SPI_READ         0x80
+#define BMI270_BURST_LEN        15   ///< Accel (6) + gyro (6) + SENSORTIME (3) bytes
+
+#define IMU_TIME_DRIFT_MAX_PPB  50000000 ///< The BMI270 oscillator is within a few percent
+
+BUILD_ASSERT(IMU_TIME_TICK_HZ % IMU_ODR_HZ == 0, "ODR must be a divider of the SENSORTIME rate");
+
+// ------------------ Variables ------------------
+
+static const struct spi_dt_spec imu_bus = SPI_DT_SPEC_GET(IMU_NODE, SPI_WORD_SET(8) | SPI_TRANSFER_MSB, 0);
+
+static struct {
+    bool anchored;
+    uint32_t st_last;          ///< Last SENSORTIME value, 24 bits
+    uint64_t st_ext;           ///< Unwrapped SENSORTIME, ticks
+    int64_t anchor_us;         ///< Sensor time the drift term is relative to, microseconds
+    int64_t offset_us;         ///< System minus sensor time at the anchor, microseconds
+    int32_t drift_ppb;         ///< Sensor clock rate error, parts per billion
+    int64_t floor_start_us;    ///< Sensor time the current floor window started at
+    int64_t floor_min;         ///< Smallest residual of the current floor window, microseconds
+    int64_t win_start_us;      ///< Sensor time the current drift window started at
+    int64_t win_start_offset;  ///< offset_us when the current drift window started
+} model;
+
+static struct imu_time_stats stats;
+
+// ------------------ Functions ------------------
+
+static inline int64_t imu_time_ticks_to_us(uint64_t ticks)
+{
+    return (int64_t)(ticks * 625 / 16); // 1 / 25600 Hz = 625 / 16 us
+}
+
+/**
+ * @brief Map a sensor time to the system clock with the current model.
+ */
+static inline int64_t imu_time_model(int64_t sensor_us)
+{
+    return sensor_us + model.offset_us + (sensor_us - model.anchor_us) * model.drift_ppb / 1000000000LL;
+}
+
+int imu_time_init(void)
+{
+    if (!spi_is_ready_dt(&imu_bus)) {
+        LOG_ERR("IMU SPI bus is not ready");
+        return -ENODEV;
+    }
+
+    imu_time_reset();
+    return 0;
+}
+
+void imu_time_reset(void)
+{
+    memset(&model, 0, sizeof(model));
+    memset(&stats, 0, sizeof(stats));
+}
+
+int64_t imu_time_map(uint32_t sensortime, int64_t host_us)
+{
+    uint32_t st = sensortime & IMU_TIME_MASK;
+
+    if (!model.anchored) {
+        model.anchored = true;
+        model.st_ext = st;
+        model.anchor_us = imu_time_ticks_to_us(st);
+        model.offset_us = host_us - model.anchor_us;
+        model.floor_start_us = model.anchor_us;
+        model.floor_min = INT64_MAX;
+        model.win_start_us = model.anchor_us;
+        model.win_start_offset = model.offset_us;
+    } else {
+        if (st < model.st_last) {
+            stats.wraps++;
+        }
+        model.st_ext += (st - model.st_last) & IMU_TIME_MASK;
+    }
+    model.st_last = st;
+
+    int64_t sensor_us = imu_time_ticks_to_us(model.st_ext);
+    int64_t residual = host_us - imu_time_model(sensor_us);
+
+    // Delays only ever make the host stamp late: follow a negative residual at once, and
+    // raise the offset by the smallest residual of each CONFIG_IMU_TIME_FLOOR_MS window, so
+    // late stamps never pull the mapping.
+    if (residual < 0) {
+        model.offset_us += residual;
+        residual = 0;
+    }
+    model.floor_min = MIN(model.floor_min, residual);
+
+    if (sensor_us - model.floor_start_us >= CONFIG_IMU_TIME_FLOOR_MS * 1000LL) {
+        model.offset_us += model.floor_min;
+        model.floor_start_us = sensor_us;
+        model.floor_min = INT64_MAX;
+    }
+
+    // Offset corrections over a drift window are the rate error the model is missing. Fold
+    // the current drift term into the offset, re-anchor, and add the new estimate.
+    int64_t elapsed = sensor_us - model.win_start_us;
+
+    if (elapsed >= CONFIG_IMU_TIME_DRIFT_WINDOW_MS * 1000LL) {
+        int64_t d_off = model.offset_us - model.win_start_offset;
+        int64_t drift = model.drift_ppb + d_off * 1000000000LL / elapsed;
+
+        model.offset_us += (sensor_us - model.anchor_us) * model.drift_ppb / 1000000000LL;
+        model.anchor_us = sensor_us;
+        model.drift_ppb = CLAMP(drift, -IMU_TIME_DRIFT_MAX_PPB, IMU_TIME_DRIFT_MAX_PPB);
+        model.win_start_us = sensor_us;
+        model.win_start_offset = model.offset_us;
+    }
+
+    stats.reads++;
+    stats.offset_us = model.offset_us;
+    stats.drift_ppb = model.drift_ppb;
+    stats.jitter_last = (int32_t)CLAMP(residual, INT32_MIN, INT32_MAX);
+    stats.jitter_max = MAX(stats.jitter_max, stats.jitter_last);
+
+    // the data registers hold the sample of the last data-ready edge
+    uint64_t edge = model.st_ext - model.st_ext % IMU_TIME_SAMPLE_TICKS;
+
+    return imu_time_model(imu_time_ticks_to_us(edge));
+}
+
+int imu_time_read(struct imu_sample *sample)
+{
+    uint8_t addr = BMI270_REG_ACC_X_LSB | BMI270_SPI_READ;
+    uint8_t buf[BMI270_BURST_LEN];
+    const struct spi_buf tx_buf = { .buf = &addr, .len = 1 };
+    const struct spi_buf_set tx = { .buffers = &tx_buf, .count = 1 };
+    struct spi_buf rx_buf[2] = {
+        { .buf = NULL, .len = 2 }, // address and dummy byte
+        { .buf = buf, .len = sizeof(buf) },
+    };
+    const struct spi_buf_set rx = { .buffers = rx_buf, .count = ARRAY_SIZE(rx_buf) };
+
+    int ret = spi_transceive_dt(&imu_bus, &tx, &rx);
+    int64_t host_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        int16_t acc = (int16_t)sys_get_le16(&buf[2 * i]);
+        int16_t gyr = (int16_t)sys_get_le16(&buf[6 + 2 * i]);
+
+        sample->acc[i] = (int32_t)(acc * IMU_ACCEL_RANGE_UMS2 / 32768);
+        sample->gyr[i] = (int32_t)(gyr * IMU_GYRO_RANGE_URADS / 32768);
+    }
+    sample->t_us = imu_time_map(sys_get_le24(&buf[12]), host_us);
+
+    return 0;
+}
+
+void imu_time_get_stats(struct imu_time_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_imutime_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    struct imu_time_stats s = stats;
+
+    shell_print(sh, "reads: %u, wraps: %u, offset: %lld us, drift: %d ppb", s.reads, s.wraps,
+                (long long)s.offset_us, s.drift_ppb);
+    shell_print(sh, "host stamp jitter last: %d us, max: %d us", s.jitter_last, s.jitter_max);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_imutime,
+    SHELL_CMD(stats, NULL, "Sensor to system clock mapping", cmd_imutime_stats),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(imutime, &sub_imutime, "IMU sample timestamps", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,90 @@
+/**
+ * @brief This is the imu_time.h header of the application. BMI270 sensor-time based sample timestamps.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_time.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_TIME_H_
+#define IMU_TIME_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include "imu.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_TIME_TICK_HZ        25600                           ///< SENSORTIME tick rate, 39.0625 us per tick
+#define IMU_TIME_MASK           0xFFFFFF                        ///< SENSORTIME is a 24-bit counter
+#define IMU_TIME_SAMPLE_TICKS   (IMU_TIME_TICK_HZ / IMU_ODR_HZ) ///< SENSORTIME ticks per data-ready period
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Sensor to system clock mapping statistics.
+ */
+struct imu_time_stats {
+    uint32_t reads;      ///< Sensor-time readings fed to the model
+    uint32_t wraps;      ///< SENSORTIME wrap-arounds (every 655.36 s)
+    int64_t offset_us;   ///< System minus sensor time at the anchor, microseconds
+    int32_t drift_ppb;   ///< Sensor clock rate error against the system clock, parts per billion
+    int32_t jitter_last; ///< Host stamp minus model of the last reading, microseconds
+    int32_t jitter_max;  ///< Largest host stamp minus model seen, microseconds
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Check the IMU bus and reset the clock model.
+ *
+ * @return int 0 on success, negative error code on failure.
+ */
+int imu_time_init(void);
+
+/**
+ * @brief Forget the clock model, the next reading re-anchors it.
+ */
+void imu_time_reset(void);
+
+/**
+ * @brief Read accelerometer, gyroscope and SENSORTIME in one SPI burst and timestamp the sample.
+ *
+ * Replaces sensor_sample_fetch() in the acquisition path: the data registers and SENSORTIME
+ * are latched together by the sensor, so the timestamp matches the data and costs no extra
+ * transaction. The sensor must be configured with IMU_ACCEL_RANGE_G, IMU_GYRO_RANGE_DPS and
+ * IMU_ODR_HZ. No bias correction is applied.
+ *
+ * @param sample Sample to fill in, t_us included.
+ * @return int 0 on success, negative error code on failure.
+ */
+int imu_time_read(struct imu_sample *sample);
+
+/**
+ * @brief Feed one SENSORTIME reading to the clock model and map it to the system clock.
+ *
+ * The host stamp only bounds the sensor time from above (bus and scheduling delays are always
+ * positive), so the offset follows the smallest residual of every CONFIG_IMU_TIME_FLOOR_MS
+ * and the drift is tracked from the offset corrections over CONFIG_IMU_TIME_DRIFT_WINDOW_MS.
+ * For a FIFO batch, pass the SENSORTIME frame that follows it: it maps the newest frame,
+ * older ones are 1/IMU_ODR_HZ apart.
+ *
+ * @param sensortime SENSORTIME register value, 24 bits.
+ * @param host_us System uptime right after the reading, microseconds.
+ * @return int64_t System time of the last data-ready edge before the reading, microseconds.
+ */
+int64_t imu_time_map(uint32_t sensortime, int64_t host_us);
+
+/**
+ * @brief Get the clock model statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_time_get_stats(struct imu_time_stats *stats);
+
+#endif /* IMU_TIME_H_ */
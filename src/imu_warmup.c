@@ -0,0 +1,320 @@
+/**
+ * @brief This is the imu_warmup.c source code of the application. Background IMU bring-up, self-test and initial bias estimation.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_warmup.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/drivers/sensor.h>
+#include "imu.h"
+#include "imu_calib.h"
+#include "imu_dsp.h"
+#include "imu_power.h"
+#include "imu_time.h"
+#include "imu_warmup.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(imu_warmup, CONFIG_LOG_DEFAULT_LEVEL);
+
+#define IMU_WARMUP_EVT_READY    BIT(0)
+#define IMU_WARMUP_EVT_FAILED   BIT(1)
+
+#define IMU_WARMUP_PERIOD_US    (USEC_PER_SEC / IMU_ODR_HZ)
+#define IMU_WARMUP_READ_TRIES   4   ///< Periods without a new sample before the sensor clock is declared stopped
+#define IMU_WARMUP_GRAVITY_TOL  (IMU_GRAVITY_UMS2 / 4) ///< Self-test: accepted error on the mean |a| at rest, micro m/s^2
+
+// ------------------ Variables ------------------
+
+static K_EVENT_DEFINE(warmup_events);
+static K_SEM_DEFINE(warmup_start, 0, 1);
+static K_TIMER_DEFINE(warmup_timer, NULL, NULL);
+static const struct device *imu_dev;
+static int64_t last_t_us;
+static struct imu_warmup_stats stats = { .result = -EAGAIN };
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Configure the IMU sensor's accelerometer and gyroscope.
+ *
+ * Only full scale and oversampling are set here, the sampling frequencies (and with them the
+ * power mode) are owned by the power policy, see imu_power.h.
+ *
+ * @return int 0 on success, negative error code on failure.
+ */
+static int imu_warmup_configure(void)
+{
+    struct sensor_value full_scale, sampling_freq, oversampling;
+    int ret;
+
+    if (!device_is_ready(imu_dev)) {
+        LOG_ERR("Sensor device is not ready");
+        return -ENODEV;
+    }
+
+    /* If already sampling, change sampling frequency to 0.0Hz before
+     * changing other attributes
+     */
+    sampling_freq.val1 = 0;
+    sampling_freq.val2 = 0;
+    sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &sampling_freq);
+    sensor_attr_set(imu_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &sampling_freq);
+
+    /* Setting scale in G, due to loss of precision if the SI unit m/s^2
+     * is used
+     */
+    full_scale.val1 = IMU_ACCEL_RANGE_G; /* G */
+    full_scale.val2 = 0;
+    oversampling.val1 = 1;          /* Normal mode */
+    oversampling.val2 = 0;
+
+    ret = sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &full_scale);
+    ret = ret ? ret : sensor_attr_set(imu_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OVERSAMPLING, &oversampling);
+
+    /* Setting scale in degrees/s to match the sensor scale */
+    full_scale.val1 = IMU_GYRO_RANGE_DPS; /* dps */
+    full_scale.val2 = 0;
+
+    ret = ret ? ret : sensor_attr_set(imu_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &full_scale);
+    ret = ret ? ret : sensor_attr_set(imu_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_OVERSAMPLING, &oversampling);
+    if (ret < 0) {
+        LOG_ERR("Failed to configure IMU sensor: %d", ret);
+        return ret;
+    }
+
+    LOG_INF("IMU sensor configured successfully.");
+    return 0;
+}
+
+/**
+ * @brief Bring up the sensor and the IMU modules, then switch to full ODR.
+ */
+static int imu_warmup_bringup(void)
+{
+    int ret = imu_warmup_configure();
+    if (ret < 0) {
+        return ret;
+    }
+
+    // accel-only low power until a session starts or the device is moved
+    ret = imu_power_init(imu_dev);
+    if (ret < 0) {
+        LOG_ERR("Failed to start IMU power management: %d", ret);
+        return ret;
+    }
+
+    ret = imu_time_init();
+    if (ret < 0) {
+        LOG_ERR("Failed to initialize IMU timestamps: %d", ret);
+        return ret;
+    }
+
+    // Restore the persisted bias offsets, the estimate below refines them. Without them
+    // the estimator starts from scratch, so this is not fatal.
+    ret = imu_calib_init(imu_dev);
+    if (ret < 0) {
+        LOG_ERR("Failed to load IMU calibration: %d", ret);
+    }
+
+    ret = imu_dsp_init();
+    if (ret < 0) {
+        LOG_ERR("Failed to initialize IMU filter chain: %d", ret);
+    }
+
+    ret = imu_power_session(true);
+    if (ret < 0) {
+        LOG_ERR("Failed to bring the IMU to full ODR: %d", ret);
+        return ret;
+    }
+    return 0;
+}
+
+/**
+ * @brief Wait for the next sample and read it.
+ *
+ * @return int 0 on success, -ETIMEDOUT if the sensor clock stopped, negative error code on a failed read.
+ */
+static int imu_warmup_next(struct imu_sample *sample)
+{
+    for (int tries = 0; tries < IMU_WARMUP_READ_TRIES; tries++) {
+        k_timer_status_sync(&warmup_timer);
+
+        int ret = imu_time_read(sample);
+        if (ret < 0) {
+            return ret;
+        }
+        if (sample->t_us != last_t_us) {
+            last_t_us = sample->t_us;
+            return 0;
+        }
+    }
+    return -ETIMEDOUT;
+}
+
+/**
+ * @brief Plausibility self-test: the sensor clock runs, the data is not stuck and the
+ * accelerometer measures about 1 g.
+ *
+ * The driver does not expose the BMI270 built-in self-test, which would also need the device
+ * to be still, so only faults visible in the data stream are detected here.
+ */
+static int imu_warmup_selftest(void)
+{
+    struct imu_sample sample, first;
+    int64_t norm_sum = 0;
+    bool varies = false;
+
+    for (int i = 0; i < CONFIG_IMU_WARMUP_SELFTEST_SAMPLES; i++) {
+        int ret = imu_warmup_next(&sample);
+        if (ret < 0) {
+            LOG_ERR("IMU self-test: no data: %d", ret);
+            return ret;
+        }
+
+        if (i == 0) {
+            first = sample;
+        }
+        for (int a = 0; a < 3; a++) {
+            varies |= (sample.acc[a] != first.acc[a]) || (sample.gyr[a] != first.gyr[a]);
+        }
+        norm_sum += (int64_t)sqrtf((float)sample.acc[0] * sample.acc[0] +
+                                   (float)sample.acc[1] * sample.acc[1] +
+                                   (float)sample.acc[2] * sample.acc[2]);
+    }
+
+    int32_t norm = (int32_t)(norm_sum / CONFIG_IMU_WARMUP_SELFTEST_SAMPLES);
+
+    if (!varies) {
+        LOG_ERR("IMU self-test: output stuck");
+        return -EIO;
+    }
+    if (abs(norm - IMU_GRAVITY_UMS2) > IMU_WARMUP_GRAVITY_TOL) {
+        LOG_ERR("IMU self-test: mean |a| %d um/s^2, expected about 1 g", norm);
+        return -EIO;
+    }
+    return 0;
+}
+
+/**
+ * @brief Initial bias estimate from the samples taken while the device rests.
+ *
+ * Samples taken while moving are rejected by the estimator, the estimate ends after
+ * CONFIG_IMU_WARMUP_BIAS_MS or once CONFIG_IMU_CALIB_MIN_SAMPLES still samples were used.
+ */
+static void imu_warmup_bias(void)
+{
+    struct imu_sample sample;
+    int64_t end = k_uptime_get() + CONFIG_IMU_WARMUP_BIAS_MS;
+
+    while (k_uptime_get() < end && stats.bias_samples < CONFIG_IMU_CALIB_MIN_SAMPLES) {
+        if (imu_warmup_next(&sample) < 0) {
+            continue;
+        }
+        imu_calib_apply(&sample);
+        if (imu_calib_update(&sample)) {
+            stats.bias_samples++;
+        } else {
+            stats.bias_rejected++;
+        }
+    }
+}
+
+/**
+ * @brief Warm-up thread: runs once, while the splash screens are shown.
+ */
+static void imu_warmup_thread(void *p1, void *p2, void *p3)
+{
+    int64_t start;
+    int ret;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    k_sem_take(&warmup_start, K_FOREVER);
+    start = k_uptime_get();
+    last_t_us = INT64_MIN;
+
+    ret = imu_warmup_bringup();
+    if (ret == 0) {
+        // let the gyroscope start up and the accelerometer filters fill before trusting the data
+        k_sleep(K_MSEC(CONFIG_IMU_WARMUP_SETTLE_MS));
+        k_timer_start(&warmup_timer, K_USEC(IMU_WARMUP_PERIOD_US), K_USEC(IMU_WARMUP_PERIOD_US));
+
+        ret = imu_warmup_selftest();
+        if (ret == 0) {
+            imu_warmup_bias();
+        }
+        k_timer_stop(&warmup_timer);
+    }
+
+    stats.duration_ms = (uint32_t)(k_uptime_get() - start);
+    stats.result = ret;
+
+    if (ret < 0) {
+        LOG_ERR("IMU warm-up failed: %d", ret);
+        imu_power_session(false);
+        k_event_post(&warmup_events, IMU_WARMUP_EVT_FAILED);
+        return;
+    }
+
+    LOG_INF("IMU ready in %u ms, bias from %u still samples", stats.duration_ms, stats.bias_samples);
+    k_event_post(&warmup_events, IMU_WARMUP_EVT_READY);
+}
+
+K_THREAD_DEFINE(imu_warmup_tid, CONFIG_IMU_WARMUP_STACK_SIZE, imu_warmup_thread, NULL, NULL, NULL,
+                CONFIG_IMU_WARMUP_THREAD_PRIORITY, 0, 0);
+
+void imu_warmup_start(const struct device *sensor_dev)
+{
+    imu_dev = sensor_dev;
+    k_sem_give(&warmup_start);
+}
+
+int imu_warmup_wait(k_timeout_t timeout)
+{
+    uint32_t events = k_event_wait(&warmup_events, IMU_WARMUP_EVT_READY | IMU_WARMUP_EVT_FAILED,
+                                   false, timeout);
+
+    if (events & IMU_WARMUP_EVT_FAILED) {
+        return -EIO;
+    }
+    return (events & IMU_WARMUP_EVT_READY) ? 0 : -EAGAIN;
+}
+
+void imu_warmup_get_stats(struct imu_warmup_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_imuwarmup_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    shell_print(sh, "result: %d, duration: %u ms", stats.result, stats.duration_ms);
+    shell_print(sh, "bias samples: %u, rejected: %u", stats.bias_samples, stats.bias_rejected);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_imuwarmup,
+    SHELL_CMD(stats, NULL, "Warm-up result, duration and bias estimate samples", cmd_imuwarmup_stats),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(imuwarmup, &sub_imuwarmup, "IMU warm-up", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
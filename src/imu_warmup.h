@@ -0,0 +1,63 @@
+/**
+ * @brief This is the imu_warmup.h header of the application. Background IMU bring-up, self-test and initial bias estimation.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file imu_warmup.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef IMU_WARMUP_H_
+#define IMU_WARMUP_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Warm-up statistics.
+ */
+struct imu_warmup_stats {
+    uint32_t duration_ms;   ///< Time from start to ready or failure
+    uint32_t bias_samples;  ///< Still samples used for the initial bias estimate
+    uint32_t bias_rejected; ///< Samples rejected by the bias estimator as not still
+    int result;             ///< 0 when ready, negative error code on failure, -EAGAIN while running
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Start the IMU warm-up in the background.
+ *
+ * The warm-up thread configures the sensor and the IMU modules, brings the sensor to full ODR,
+ * lets it settle, runs a plausibility self-test and estimates the initial bias offsets while
+ * the device rests. On success the power session is left active, so acquisition can start at
+ * once with a settled and calibrated sensor.
+ *
+ * @param sensor_dev Pointer to the sensor device structure.
+ */
+void imu_warmup_start(const struct device *sensor_dev);
+
+/**
+ * @brief Wait for the warm-up to finish.
+ *
+ * @param timeout How long to wait, K_NO_WAIT to poll.
+ * @return int 0 when ready, -EIO if the bring-up or self-test failed, -EAGAIN on timeout.
+ */
+int imu_warmup_wait(k_timeout_t timeout);
+
+/**
+ * @brief Get the warm-up statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void imu_warmup_get_stats(struct imu_warmup_stats *stats);
+
+#endif /* IMU_WARMUP_H_ */
@@ -0,0 +1,231 @@
+/**
+ * @brief This is the latency.c source code of the application. Motion-to-photon latency stamps and percentiles.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file latency.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page latency_page Motion-to-Photon Latency
+ * @brief A slider value is followed from the sample it was computed from to the display. The
+ * tracker stamps the value when it posts it, the UI thread marks it applied when the widgets
+ * take it, and the flush callback stamps the last area of the next frame before and after it is
+ * written. Only the newest value is followed, like the UI mailbox: a value replaced before the
+ * UI applied it never reached the display and is only counted.
+ */
+
+// ------------------ Includes ------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include "latency.h"
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Stamps of the value being followed, microseconds on the system clock.
+ */
+struct latency_trace {
+    int64_t sample_us;
+    int64_t processed_us;
+    int64_t rendered_us;
+    bool valid;
+};
+
+// ------------------ Variables ------------------
+
+static struct k_spinlock trace_lock;
+static struct latency_trace pending;    // posted by the tracker, not applied yet
+static struct latency_trace shown;      // applied, waiting for its frame to be written
+static uint32_t window[LATENCY_STAGE_COUNT][CONFIG_LATENCY_WINDOW];
+static uint32_t frames;
+static uint32_t replaced;
+static uint32_t display_us;     // running average of render + transfer
+
+// ------------------ Functions ------------------
+
+static inline int64_t latency_now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static inline uint32_t latency_us(int64_t from, int64_t to)
+{
+    return (uint32_t)CLAMP(to - from, 0, UINT32_MAX);
+}
+
+void latency_stamp_processed(int64_t sample_us)
+{
+    int64_t now = latency_now_us();
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    if (pending.valid) {
+        replaced++;
+    }
+    pending = (struct latency_trace){
+        .sample_us = sample_us,
+        .processed_us = now,
+        .valid = true,
+    };
+
+    k_spin_unlock(&trace_lock, key);
+}
+
+void latency_stamp_applied(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    if (pending.valid) {
+        if (shown.valid) {
+            replaced++;
+        }
+        shown = pending;
+        pending.valid = false;
+    }
+
+    k_spin_unlock(&trace_lock, key);
+}
+
+void latency_stamp_rendered(void)
+{
+    int64_t now = latency_now_us();
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    if (shown.valid) {
+        shown.rendered_us = now;
+    }
+
+    k_spin_unlock(&trace_lock, key);
+}
+
+void latency_stamp_flushed(void)
+{
+    int64_t now = latency_now_us();
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    if (shown.valid && shown.rendered_us != 0) {
+        uint32_t slot = frames % CONFIG_LATENCY_WINDOW;
+
+        window[LATENCY_PROCESS][slot] = latency_us(shown.sample_us, shown.processed_us);
+        window[LATENCY_RENDER][slot] = latency_us(shown.processed_us, shown.rendered_us);
+        window[LATENCY_TRANSFER][slot] = latency_us(shown.rendered_us, now);
+        window[LATENCY_AGE][slot] = latency_us(shown.sample_us, shown.rendered_us);
+        window[LATENCY_TOTAL][slot] = latency_us(shown.sample_us, now);
+
+        int32_t display = (int32_t)latency_us(shown.processed_us, now);
+
+        display_us = (uint32_t)((frames == 0) ? display :
+                                (int32_t)display_us + (display - (int32_t)display_us) / 8);
+        frames++;
+        shown.valid = false;
+    }
+
+    k_spin_unlock(&trace_lock, key);
+}
+
+static int latency_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of a sorted window.
+ */
+static inline uint32_t latency_rank(const uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+    return sorted[(pct * n + 99) / 100 - 1];
+}
+
+void latency_get_stats(struct latency_stats *out)
+{
+    static uint32_t sorted[CONFIG_LATENCY_WINDOW]; // shell thread only
+    k_spinlock_key_t key;
+
+    *out = (struct latency_stats){0};
+
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        key = k_spin_lock(&trace_lock);
+        out->frames = frames;
+        out->replaced = replaced;
+        out->window = MIN(frames, CONFIG_LATENCY_WINDOW);
+        memcpy(sorted, window[s], out->window * sizeof(sorted[0]));
+        k_spin_unlock(&trace_lock, key);
+
+        if (out->window == 0) {
+            return;
+        }
+
+        qsort(sorted, out->window, sizeof(sorted[0]), latency_cmp);
+        out->stage[s].p50 = latency_rank(sorted, out->window, 50);
+        out->stage[s].p90 = latency_rank(sorted, out->window, 90);
+        out->stage[s].p99 = latency_rank(sorted, out->window, 99);
+        out->stage[s].max = sorted[out->window - 1];
+    }
+}
+
+uint32_t latency_display_us(void)
+{
+    return display_us;
+}
+
+void latency_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&trace_lock);
+
+    pending.valid = false;
+    shown.valid = false;
+    frames = 0;
+    replaced = 0;
+
+    k_spin_unlock(&trace_lock, key);
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_latency_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    static const char *const names[] = {
+        [LATENCY_PROCESS] = "process",
+        [LATENCY_RENDER] = "render",
+        [LATENCY_TRANSFER] = "transfer",
+        [LATENCY_AGE] = "age",
+        [LATENCY_TOTAL] = "total",
+    };
+    struct latency_stats s;
+
+    latency_get_stats(&s);
+    shell_print(sh, "frames: %u, values replaced: %u, window: %u", s.frames, s.replaced, s.window);
+    shell_print(sh, "%-9s %8s %8s %8s %8s (us)", "stage", "p50", "p90", "p99", "max");
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        shell_print(sh, "%-9s %8u %8u %8u %8u", names[i], s.stage[i].p50, s.stage[i].p90,
+                    s.stage[i].p99, s.stage[i].max);
+    }
+    return 0;
+}
+
+static int cmd_latency_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    latency_reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_latency,
+    SHELL_CMD(stats, NULL, "Motion-to-photon latency percentiles per stage", cmd_latency_stats),
+    SHELL_CMD(reset, NULL, "Clear the latency measurements", cmd_latency_reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(latency, &sub_latency, "Motion-to-photon latency", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,100 @@
+/**
+ * @brief This is the latency.h header of the application. Motion-to-photon latency stamps and percentiles.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file latency.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Pipeline stages. Process, render and transfer follow each other, age and total are
+ * measured from the sample.
+ */
+enum latency_stage {
+    LATENCY_PROCESS,    ///< Sample data-ready to slider value posted, by the tracker or the UI latch
+    LATENCY_RENDER,     ///< Slider value posted to the frame showing it drawn by LVGL
+    LATENCY_TRANSFER,   ///< Frame drawn to its last area written to the display
+    LATENCY_AGE,        ///< Sample data-ready to frame drawn, age of the sample when rendered
+    LATENCY_TOTAL,      ///< Sample data-ready to last area written, motion to photon
+    LATENCY_STAGE_COUNT,
+};
+
+/**
+ * @brief Percentiles of one stage over the last CONFIG_LATENCY_WINDOW frames, microseconds.
+ */
+struct latency_percentiles {
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+};
+
+/**
+ * @brief Latency statistics.
+ */
+struct latency_stats {
+    uint32_t frames;    ///< Frames measured since the last reset
+    uint32_t replaced;  ///< Slider values replaced by a newer one before reaching the display
+    uint32_t window;    ///< Frames the percentiles are computed over
+    struct latency_percentiles stage[LATENCY_STAGE_COUNT];
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Stamp a slider value posted to the UI, from the tracker thread.
+ *
+ * @param sample_us Data-ready time of the sample the value was computed from, microseconds.
+ */
+void latency_stamp_processed(int64_t sample_us);
+
+/**
+ * @brief The last stamped value was applied to the widgets, from the UI thread.
+ */
+void latency_stamp_applied(void);
+
+/**
+ * @brief The last area of a frame was drawn and is about to be written, from the flush callback.
+ */
+void latency_stamp_rendered(void);
+
+/**
+ * @brief The last area of a frame was written to the display, from the flush callback.
+ */
+void latency_stamp_flushed(void);
+
+/**
+ * @brief Running average of the time from a posted value to its frame written to the display.
+ *
+ * This is how far ahead the displayed state should be predicted, see fusion_predict().
+ *
+ * @return uint32_t Average of render plus transfer, microseconds, 0 before the first frame.
+ */
+uint32_t latency_display_us(void);
+
+/**
+ * @brief Get the frame counters and the per-stage percentiles.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void latency_get_stats(struct latency_stats *stats);
+
+/**
+ * @brief Clear the measurements, e.g. before judging a change.
+ */
+void latency_reset(void);
+
+#endif /* LATENCY_H_ */
@@ -32,6 +32,17 @@
 #include <lvgl.h> // Graphics library
 #include <string.h>
 #include <zephyr/logging/log.h>
+#include "imu.h"
+#include "imu_acq.h"
+#include "imu_calib.h"
+#include "imu_power.h"
+#include "imu_rec.h"
+#include "imu_warmup.h"
+#include "tracker.h"
+#include "ui_gate.h"
+#include "ui_mbox.h"
+#include "ui_port.h"
+#include "ui_tracking.h"
 
 
 // ------------------ Macros ------------------
@@ -39,6 +50,14 @@
 #define LOG_LEVEL CONFIG_LOG_DEFAULT_LEVEL
 LOG_MODULE_REGISTER(app);
 
+// application flow timing, ms
+#define APP_SPLASH_MS   3000    // logo
+#define APP_MENU_MS     3000    // instructions
+#define APP_HOLD_MS     10000   // level hold to complete a recording
+#define APP_RESULT_MS   5000    // "Check your mobile"
+#define APP_ERROR_MS    5000    // "Sensor error"
+#define APP_FRAME_MS    10      // UI frame period while tracking or drawing
+
 // button configuration
 #ifdef CONFIG_GPIO
 static struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(DT_ALIAS(sw0), gpios, {0});
@@ -105,89 +124,18 @@ static void initialize_display(const struct device *display_dev) {
 }
 
 /**
- * @brief Setup the BMI270 IMU sensor.
+ * @brief Build the Cairdio & Rice logo splash screen.
  *
- * @param sensor_dev Pointer to the sensor device structure.
+ * @param scr Screen to build on.
  */
-static void setup_sensors(const struct device *sensor_dev) {
-    if (!device_is_ready(sensor_dev)) {
-        LOG_ERR("Device %s is not ready\n", sensor_dev->name);
-        return;
-    }
-    LOG_INF("Sensor initialized, device %p name is %s\n", sensor_dev, sensor_dev->name);
-
-    // Configure sensor parameters here if necessary
-}
-
-/**
- * @brief Configure the IMU sensor's accelerometer and gyroscope.
- * 
- * @param sensor_dev Pointer to the sensor device structure.
- * @return int 0 on success, negative error code on failure.
- */
-int configure_imu_sensor(const struct device *sensor_dev) {
-	struct sensor_value full_scale, sampling_freq, oversampling;
-
-    if (!device_is_ready(sensor_dev)) {
-        LOG_ERR("Sensor device is not ready");
-        return -ENODEV;
-    }
-
-    // Configure the accelerometer
-	/* Setting scale in G, due to loss of precision if the SI unit m/s^2
-	 * is used
-	 */
-    full_scale.val1 = 2;            /* G */
-	full_scale.val2 = 0;
-	sampling_freq.val1 = 100;       /* Hz. Performance mode */
-	sampling_freq.val2 = 0;
-	oversampling.val1 = 1;          /* Normal mode */
-	oversampling.val2 = 0;
-
-    sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_FULL_SCALE, &full_scale);
-    sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_OVERSAMPLING, &oversampling);
-	/* Set sampling frequency last as this also sets the appropriate
-	 * power mode. If already sampling, change to 0.0Hz before changing
-	 * other attributes
-	 */
-    sensor_attr_set(sensor_dev, SENSOR_CHAN_ACCEL_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &sampling_freq);
-
-    // Configure the gyroscope
-    /* Setting scale in degrees/s to match the sensor scale */
-	full_scale.val1 = 500;          /* dps */
-	full_scale.val2 = 0;
-	sampling_freq.val1 = 100;       /* Hz. Performance mode */
-	sampling_freq.val2 = 0;
-	oversampling.val1 = 1;          /* Normal mode */
-	oversampling.val2 = 0;
-
-	sensor_attr_set(sensor_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_FULL_SCALE, &full_scale);
-	sensor_attr_set(sensor_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_OVERSAMPLING, &oversampling);
-	/* Set sampling frequency last as this also sets the appropriate
-	 * power mode. If already sampling, change sampling frequency to
-	 * 0.0Hz before changing other attributes
-	 */
-	sensor_attr_set(sensor_dev, SENSOR_CHAN_GYRO_XYZ, SENSOR_ATTR_SAMPLING_FREQUENCY, &sampling_freq);
-
-    LOG_INF("IMU sensor configured successfully.");
-    return 0;
-}
-
-/**
- * @brief Displays Cairdio & Rice logo for 3 seconds, then removes it after a delay.
- * 
- * @param display_dev Pointer to the display device structure.
- * @return void
- */
-void display_logo_animation(const struct device *display_dev) {
-	LOG_INF("Loading logo...");
+static void splash_screen_create(lv_obj_t *scr) {
 
     // Initialize a style for the logo
     static lv_style_t style;
     lv_style_init(&style);
 
     // Create an image object and apply the style
-    lv_obj_t *obj_logo = lv_img_create(lv_scr_act());
+    lv_obj_t *obj_logo = lv_img_create(scr);
     lv_obj_add_style(obj_logo, &style, 0);
 
     // Declare the image source
@@ -196,36 +144,23 @@ void display_logo_animation(const struct device *display_dev) {
 
     // Center the image on the screen
     lv_obj_center(obj_logo);
-
-    // Refresh the display to show the image
-    lv_task_handler();
-    if (display_dev) {
-        display_blanking_off(display_dev);
-    }
-
-    // Delay for 3 seconds to display the logo
-    k_sleep(K_MSEC(3000));
-
-    // Delete the logo object to clear it from the screen
-    lv_obj_del(obj_logo);
 }
 
 /**
- * @brief Display menu including bluetooth status, logo, battery status and text for 3 seconds, then clear them after a delay.
+ * @brief Build the menu including bluetooth status, logo, battery status and instructions.
  *
- * @param display_dev Pointer to the display device structure.
+ * @param scr Screen to build on.
  */
-void menu(const struct device *display_dev) {
-	LOG_INF("Loading menu...");
+static void menu_screen_create(lv_obj_t *scr) {
 
     // Initialize styles
     static lv_style_t style;
     lv_style_init(&style);
 
     // Create logo objects
-    lv_obj_t *obj_cairdio_logo = lv_img_create(lv_scr_act()); // cairdio logo
-    lv_obj_t *obj_bluetooth_status = lv_img_create(lv_scr_act()); // bluetooth status
-    lv_obj_t *obj_battery_status = lv_img_create(lv_scr_act()); // battery status
+    lv_obj_t *obj_cairdio_logo = lv_img_create(scr); // cairdio logo
+    lv_obj_t *obj_bluetooth_status = lv_img_create(scr); // bluetooth status
+    lv_obj_t *obj_battery_status = lv_img_create(scr); // battery status
 
     // Apply styles
     lv_obj_add_style(obj_cairdio_logo, &style, 0);
@@ -252,81 +187,296 @@ void menu(const struct device *display_dev) {
     lv_obj_align(obj_battery_status, LV_ALIGN_CENTER, 72, -78); // top right
 
     // Add text label for instructions
-    lv_obj_t *count_label = lv_label_create(lv_scr_act());
+    lv_obj_t *count_label = lv_label_create(scr);
     lv_label_set_text(count_label, "Hold the device\n for 10 seconds");
     lv_obj_align(count_label, LV_ALIGN_CENTER, 0, 0); // center
+}
 
-    // Refresh display
-    lv_task_handler();
-    if (display_dev) {
-        display_blanking_off(display_dev);
-    }
+/**
+ * @brief Build the screen with the text "Check your mobile for the result".
+ *
+ * @param scr Screen to build on.
+ */
+static void result_screen_create(lv_obj_t *scr) {
+	lv_obj_t * check_mobile_label = lv_label_create(scr);
+	lv_label_set_text(check_mobile_label, "Check your mobile\n for the result");
+	lv_obj_align(check_mobile_label, LV_ALIGN_CENTER, 0, 0); // align on the center of the screen
+}
+
+/**
+ * @brief Build the screen shown instead of tracking when the IMU could not be brought up.
+ *
+ * @param scr Screen to build on.
+ */
+static void error_screen_create(lv_obj_t *scr) {
+	lv_obj_t *error_label = lv_label_create(scr);
+	lv_label_set_text(error_label, "Sensor error\n please restart");
+	lv_obj_set_style_text_color(error_label, lv_color_hex(0xFF0000), LV_PART_MAIN);
+	lv_obj_align(error_label, LV_ALIGN_CENTER, 0, 0);
+}
+
+// ------------------ Application State Machine ------------------
 
-    // Delay for 3 seconds
-    k_sleep(K_MSEC(3000));
+/**
+ * @brief Screens of the application flow, each ends at an uptime deadline.
+ */
+enum app_state {
+	APP_SPLASH,   ///< Logo, APP_SPLASH_MS
+	APP_MENU,     ///< Instructions, APP_MENU_MS and until the IMU warm-up is done
+	APP_TRACKING, ///< Slider and countdown, until held level for APP_HOLD_MS
+	APP_RESULT,   ///< "Check your mobile", APP_RESULT_MS
+	APP_ERROR,    ///< "Sensor error" instead of tracking when the IMU warm-up failed, APP_ERROR_MS
+	APP_DONE,
+};
 
-    // Clean up
-    lv_obj_del(obj_cairdio_logo);
-    lv_obj_del(obj_bluetooth_status);
-    lv_obj_del(obj_battery_status);
-    lv_obj_del(count_label);
+/**
+ * @brief Application flow context, owned by the main thread.
+ */
+struct app {
+	enum app_state state;
+	int64_t deadline;                  ///< Uptime at which the current state ends, ms
+	const struct device *display_dev;
+	bool display_on;                   ///< Blanking turned off after the first rendered frame
+	lv_obj_t *scr[APP_DONE];           ///< Screen of each state, built ahead of its transition
+	struct ui_tracking tracking;       ///< Tracking screen and its UI state
+};
+
+static const enum app_state app_next[] = {
+	[APP_SPLASH] = APP_MENU,
+	[APP_MENU] = APP_TRACKING,
+	[APP_TRACKING] = APP_RESULT,
+	[APP_RESULT] = APP_DONE,
+	[APP_ERROR] = APP_DONE,
+};
+
+static K_SEM_DEFINE(app_wake, 0, 1);
+
+static void app_deadline_expiry(struct k_timer *timer) {
+	ARG_UNUSED(timer);
+
+	k_sem_give(&app_wake);
 }
 
+static K_TIMER_DEFINE(app_deadline_timer, app_deadline_expiry, NULL);
+
 /**
- * @brief Display system status including bluetooth status, logo and battery status.
+ * @brief Set the deadline of the current state, the main thread is woken when it passes.
  *
- * @param display_dev Pointer to the display device structure.
+ * @param app Application context.
+ * @param deadline Uptime, ms.
  */
-void system_status_bar(const struct device *display_dev, lv_obj_t *obj_cairdio_logo, lv_obj_t *obj_bluetooth_status, lv_obj_t *obj_battery_status) {
-	// Initialize styles
-    static lv_style_t style;
-    lv_style_init(&style);
+static void app_set_deadline(struct app *app, int64_t deadline) {
+	app->deadline = deadline;
+	k_timer_start(&app_deadline_timer, K_TIMEOUT_ABS_MS(deadline), K_NO_WAIT);
+}
 
-    // Apply styles
-    lv_obj_add_style(obj_cairdio_logo, &style, 0);
-    lv_obj_add_style(obj_bluetooth_status, &style, 0);
-    lv_obj_add_style(obj_battery_status, &style, 0);
+/**
+ * @brief Build the screen of a state off-screen, nothing is drawn until it is loaded.
+ *
+ * @param app Application context.
+ * @param state State to build the screen of.
+ */
+static void app_prepare(struct app *app, enum app_state state) {
+	lv_obj_t *scr = lv_obj_create(NULL);
 
-    // Declare images
-    LV_IMG_DECLARE(cairdio_logo);
-    LV_IMG_DECLARE(bluetooth_connected);
-    LV_IMG_DECLARE(battery_50_percentage);
+	switch (state) {
+	case APP_SPLASH:
+		splash_screen_create(scr);
+		break;
 
-    // Set sources
-    lv_img_set_src(obj_cairdio_logo, &cairdio_logo);
-    lv_img_set_src(obj_bluetooth_status, &bluetooth_connected);
-    lv_img_set_src(obj_battery_status, &battery_50_percentage);
+	case APP_MENU:
+		menu_screen_create(scr);
+		break;
 
-    // Set zoom and alignment
-    lv_img_set_zoom(obj_cairdio_logo, 150);
-    lv_img_set_zoom(obj_bluetooth_status, 100);
-    lv_img_set_zoom(obj_battery_status, 100);
+	case APP_TRACKING:
+		ui_tracking_create(&app->tracking, scr, APP_HOLD_MS);
+		break;
 
-    lv_obj_align(obj_cairdio_logo, LV_ALIGN_CENTER, 0, -80); // top center
-    lv_obj_align(obj_bluetooth_status, LV_ALIGN_CENTER, -65, -78); // top left
-    lv_obj_align(obj_battery_status, LV_ALIGN_CENTER, 72, -78); // top right
+	case APP_RESULT:
+		result_screen_create(scr);
+		break;
+
+	case APP_ERROR:
+		error_screen_create(scr);
+		break;
+
+	default:
+		break;
+	}
+	app->scr[state] = scr;
 }
 
 /**
- * @brief Process sensor data to fetch accelerometer and gyro readings.
+ * @brief Leave the current screen and enter a new state.
  *
- * @param sensor_dev Pointer to the sensor device structure.
- * * @return Ay The accelerometer's Y-axis value, with type int.
+ * @param app Application context.
+ * @param state State to enter.
+ * @param now Current uptime, ms.
  */
-int process_sensor_data(const struct device *sensor_dev) {
-    struct sensor_value acc[3], gyr[3];
+static void app_enter(struct app *app, enum app_state state, int64_t now) {
+	lv_obj_t *prev = lv_scr_act();
+
+	app->state = state;
+	if (state == APP_DONE) {
+		// Clear the screen
+		lv_obj_clean(prev);
+		k_timer_stop(&app_deadline_timer);
+		return;
+	}
 
-    if (sensor_sample_fetch(sensor_dev) < 0) {
-        LOG_ERR("Failed to fetch sensor data");
-        return;
-    }
+	// swap to the prepared screen, it is only built here if its preparation did not get a turn
+	ui_gate_transition();
+	if (app->scr[state] == NULL) {
+		app_prepare(app, state);
+	}
+	lv_scr_load(app->scr[state]);
+	app->scr[state] = NULL;
+	lv_obj_del(prev);
+
+	switch (state) {
+	case APP_SPLASH:
+		LOG_INF("Loading logo...");
+		app_set_deadline(app, now + APP_SPLASH_MS);
+		break;
+
+	case APP_MENU:
+		LOG_INF("Loading menu...");
+		app_set_deadline(app, now + APP_MENU_MS);
+		break;
+
+	case APP_TRACKING:
+		LOG_INF("Starting orientation detection...");
+		// the warm-up left the sensor settled at full ODR
+		if (imu_power_session(true) < 0 || imu_acq_start() < 0) {
+			LOG_ERR("IMU not ready, skipping tracking");
+			imu_power_session(false);
+			app_enter(app, APP_ERROR, now);
+			return;
+		}
+		imu_rec_start();
+		tracker_start();
+		app_set_deadline(app, now + APP_HOLD_MS);
+		break;
+
+	case APP_RESULT: {
+		// print the text "Complete recording" in terminal
+		LOG_INF("Complete recording");
+		imu_acq_stop();
+		tracker_stop();
+		imu_rec_stop();
+		imu_power_session(false);
+		imu_calib_save();
+
+		struct imu_rec_stats rec_stats;
+		imu_rec_get_stats(&rec_stats);
+		LOG_INF("Recorded %u frames in %u bytes", rec_stats.frames, rec_stats.bytes);
+
+		app_set_deadline(app, now + APP_RESULT_MS);
+		break;
+	}
 
-    sensor_channel_get(sensor_dev, SENSOR_CHAN_ACCEL_XYZ, acc);
-    sensor_channel_get(sensor_dev, SENSOR_CHAN_GYRO_XYZ, gyr);
+	case APP_ERROR:
+		LOG_INF("Loading sensor error...");
+		app_set_deadline(app, now + APP_ERROR_MS);
+		break;
 
-	return acc[1].val1;
+	default:
+		break;
+	}
 }
 
+/**
+ * @brief Tracking frame: restart the hold while tilted and apply the UI updates.
+ *
+ * @param app Application context.
+ * @param now Current uptime, ms.
+ */
+static void app_tracking_frame(struct app *app, int64_t now) {
+	// the hold restarts while tilted, a short shake does not reset it
+	if (ui_tracking_tilted(&app->tracking)) {
+		app_set_deadline(app, now + APP_HOLD_MS);
+	}
+
+	uint32_t changed = ui_tracking_frame(&app->tracking,
+					     (uint32_t)CLAMP(app->deadline - now, 0, APP_HOLD_MS));
+
+	if (changed & BIT(UI_FIELD_COUNTDOWN)) {
+		LOG_INF("Remaining: %d seconds...", (int)app->tracking.ui.value[UI_FIELD_COUNTDOWN]);
+	}
+}
+
+/**
+ * @brief Run the application flow: splash, menu, tracking, result.
+ *
+ * Transitions happen at uptime deadlines and the screen is only redrawn when it changes, so
+ * the main thread sleeps in between and the hold measures real time whatever the render load.
+ *
+ * @param display_dev Pointer to the display device structure.
+ */
+static void app_run(const struct device *display_dev) {
+	static struct app app;
+
+	app.display_dev = display_dev;
+#ifdef CONFIG_UI_PORT
+	ui_port_init(display_dev);
+#endif
+	ui_gate_init();
+	app_enter(&app, APP_SPLASH, k_uptime_get());
+
+	while (app.state != APP_DONE) {
+		int64_t now = k_uptime_get();
+
+		if (now >= app.deadline) {
+			enum app_state to = app_next[app.state];
+
+			// tracking needs a settled, calibrated sensor: the menu stays up until the warm-up
+			// reports, nothing is drawn meanwhile
+			if (app.state == APP_MENU) {
+				int ret = imu_warmup_wait(K_NO_WAIT);
+
+				if (ret == -EAGAIN) {
+					LOG_INF("Waiting for the IMU warm-up...");
+					ret = imu_warmup_wait(K_FOREVER);
+					now = k_uptime_get();
+				}
+				if (ret < 0) {
+					LOG_ERR("IMU warm-up failed (%d), skipping tracking", ret);
+					to = APP_ERROR;
+				}
+			}
+			// a screen built ahead for a state that is skipped is never loaded
+			if (to != app_next[app.state] && app.scr[app_next[app.state]] != NULL) {
+				lv_obj_del(app.scr[app_next[app.state]]);
+				app.scr[app_next[app.state]] = NULL;
+			}
+			app_enter(&app, to, now);
+			continue;
+		}
+
+		if (app.state == APP_TRACKING) {
+			app_tracking_frame(&app, now);
+		}
+
+		// redraw and retransmit only when something on screen changed
+		bool rendered = ui_gate_render();
+
+		if (rendered && !app.display_on) {
+			display_blanking_off(app.display_dev);
+			app.display_on = true;
+		}
+
+		// once the current screen is on the display, build the next one while it is showing
+		enum app_state next = app_next[app.state];
+
+		if (!rendered && next != APP_DONE && app.scr[next] == NULL) {
+			app_prepare(&app, next);
+		}
+
+		// next frame while tracking or drawing, otherwise sleep until the deadline
+		k_sem_take(&app_wake, (app.state == APP_TRACKING || rendered) ?
+				   K_MSEC(APP_FRAME_MS) : K_FOREVER);
+	}
+}
 
 // ------------------ Main Thread ------------------
 /**
@@ -341,175 +491,11 @@ int main(void) {
     setup_button();
 
 	// ------------------ BMI270 IMU Initialization ------------------
-	setup_sensors(sensor_dev);
-
-	int ret = configure_imu_sensor(sensor_dev);
-	if (ret != 0) {
-		LOG_ERR("Failed to configure IMU sensor: %d", ret);
-	}
+	// configured, self-tested and calibrated in the background while the splash screens show
+	imu_warmup_start(sensor_dev);
 
-    display_logo_animation(display_dev);
-	menu(display_dev);
-
-	// initialize accelerometer's Y-axis value
-	int Ay = 0;
-	// initialize the count down label from 10
-	int count = 10;
-	int count2 = 0;
-
-	LOG_INF("Starting orientation detection...");
-	// TODO: refactor following code into modular functions
-	// ------------------ Main Thread Loop ------------------
-    while (true) {
-		// fetch sensor data's Ay value
-		Ay = process_sensor_data(sensor_dev);
-		// print the Ay (accelerometer's Y-axis value) value in terminal
-		LOG_INF("accelerometer's Y-axis value: %d", Ay);
-
-		count2++;
-		if (count2 % 5 == 0) {
-			count--; // decrement count every 50ms
-		}
-
-		// Create system_status_bar's objects
-		lv_obj_t *obj_cairdio_logo = lv_img_create(lv_scr_act()); // cairdio logo
-		lv_obj_t *obj_bluetooth_status = lv_img_create(lv_scr_act()); // bluetooth status
-		lv_obj_t *obj_battery_status = lv_img_create(lv_scr_act()); // battery status
-		system_status_bar(display_dev, obj_cairdio_logo, obj_bluetooth_status, obj_battery_status);
-
-		// create a custom slider
-		static const lv_style_prop_t props[] = {LV_STYLE_BG_COLOR, 0};
-		static lv_style_transition_dsc_t transition_dsc;
-		lv_style_transition_dsc_init(&transition_dsc, props, lv_anim_path_linear, 300, 0, NULL);
-		static lv_style_t style_main;
-		static lv_style_t style_indicator;
-		static lv_style_t style_knob;
-		static lv_style_t style_pressed_color;
-		lv_style_init(&style_main); // background color of the slider
-		lv_style_set_bg_opa(&style_main, LV_OPA_COVER);
-		lv_style_set_bg_color(&style_main, lv_color_hex3(0xbbb));
-		lv_style_set_radius(&style_main, LV_RADIUS_CIRCLE);
-		lv_style_set_pad_ver(&style_main, -2); /*Makes the indicator larger*/
-		lv_style_init(&style_indicator); // left side of the knob
-		lv_style_set_bg_opa(&style_indicator, LV_OPA_TRANSP); // using transparent color to hide the left side of the knob
-		lv_style_init(&style_pressed_color);
-		lv_style_set_bg_color(&style_pressed_color, lv_palette_darken(LV_PALETTE_CYAN, 2));
-
-		// Create a label below the slider
-		lv_obj_t * label = lv_label_create(lv_scr_act());
-		lv_obj_t * count2_label = lv_label_create(lv_scr_act());
-		
-		char count_str[50];
-		sprintf(count_str, "Remaining: %d", count);
-		lv_label_set_text(count2_label, count_str);
-		LOG_INF("Remaining: %d seconds...", count);
-
-		// orientation detection
-		// set the text of the label to "move right" if Ay < -1
-		if (Ay < -1) {
-			lv_style_init(&style_knob);
-			lv_style_set_bg_opa(&style_knob, LV_OPA_COVER);
-			lv_style_set_bg_color(&style_knob, lv_palette_main(LV_PALETTE_RED));
-			lv_style_set_border_color(&style_knob, lv_palette_darken(LV_PALETTE_RED, 3));
-			lv_style_set_border_width(&style_knob, 2);
-			lv_style_set_radius(&style_knob, LV_RADIUS_CIRCLE);
-			lv_style_set_pad_all(&style_knob, 6); /*Makes the knob larger*/
-			lv_style_set_transition(&style_knob, &transition_dsc);
-
-			lv_label_set_text(label, "move right");
-			lv_obj_set_style_text_color(label, lv_color_hex(0xFF0000), LV_PART_MAIN|LV_STATE_DEFAULT);
-
-			// reset the count to 10 if Ay < -1
-			count = 10;
-		}
-		// set the text of the label to "move left" if Ay > 1
-		else if (Ay > 1) {	
-			lv_style_init(&style_knob);
-			lv_style_set_bg_opa(&style_knob, LV_OPA_COVER);
-			lv_style_set_bg_color(&style_knob, lv_palette_main(LV_PALETTE_RED));
-			lv_style_set_border_color(&style_knob, lv_palette_darken(LV_PALETTE_RED, 3));
-			lv_style_set_border_width(&style_knob, 2);
-			lv_style_set_radius(&style_knob, LV_RADIUS_CIRCLE);
-			lv_style_set_pad_all(&style_knob, 6); /*Makes the knob larger*/
-			lv_style_set_transition(&style_knob, &transition_dsc);
-
-			lv_label_set_text(label, "move left");
-			lv_obj_set_style_text_color(label, lv_color_hex(0xFF0000), LV_PART_MAIN|LV_STATE_DEFAULT);
-
-			// reset the count to 10 if Ay > 1
-			count = 10;
-		}
-		// set the text of the label to "stay still" if Ay is between -1 and 1
-		else {
-			lv_style_init(&style_knob);
-			lv_style_set_bg_opa(&style_knob, LV_OPA_COVER);
-			lv_style_set_bg_color(&style_knob, lv_palette_main(LV_PALETTE_GREEN));
-			lv_style_set_border_color(&style_knob, lv_palette_darken(LV_PALETTE_GREEN, 3));
-			lv_style_set_border_width(&style_knob, 2);
-			lv_style_set_radius(&style_knob, LV_RADIUS_CIRCLE);
-			lv_style_set_pad_all(&style_knob, 6); /*Makes the knob larger*/
-			lv_style_set_transition(&style_knob, &transition_dsc);
-
-			lv_label_set_text(label, "stay still");
-			lv_obj_set_style_text_color(label, lv_color_hex(0x00FF00), LV_PART_MAIN|LV_STATE_DEFAULT);
-		}
-
-		// Create the slider and apply styles
-		lv_obj_t * slider = lv_slider_create(lv_scr_act());
-		lv_obj_remove_style_all(slider);        /*Remove the styles coming from the theme*/
-		lv_obj_add_style(slider, &style_main, LV_PART_MAIN);
-		lv_obj_add_style(slider, &style_indicator, LV_PART_INDICATOR);
-		lv_obj_add_style(slider, &style_pressed_color, LV_PART_INDICATOR | LV_STATE_PRESSED);
-		lv_obj_add_style(slider, &style_knob, LV_PART_KNOB);
-		lv_obj_add_style(slider, &style_pressed_color, LV_PART_KNOB | LV_STATE_PRESSED);
-		lv_obj_set_size(slider, 200, 10);
-		lv_slider_set_range(slider, 0, 200); // set the range of the slider to 0-200
-
-		// map the value of AY to the slider, AY = -10 -> slider = 200, AY = 0 -> slider = 100, AY = 10 -> slider = 0
-		int slider_value = 100 - Ay * 10;
-		lv_slider_set_value(slider, slider_value, LV_ANIM_OFF);
-		lv_obj_center(slider);
-		lv_obj_add_event_cb(slider, NULL, LV_EVENT_VALUE_CHANGED, NULL);
-
-		lv_obj_align_to(label, slider, LV_ALIGN_OUT_BOTTOM_MID, 0, 10); // offset the label below the slider 10 pixels
-		lv_obj_align_to(count2_label, label, LV_ALIGN_OUT_BOTTOM_MID, 0, 10); // offset the count2_label below the label 10 pixels
-
-		if (count == 0) {
-			// print the text "Complete recording" in terminal
-			LOG_INF("Complete recording");
-
-			lv_obj_del(slider); // delete the object
-			lv_obj_del(label); // delete the object
-			lv_obj_del(count2_label); // delete the object
-			lv_obj_del(obj_cairdio_logo); // delete the object
-			lv_obj_del(obj_bluetooth_status); // delete the object
-			lv_obj_del(obj_battery_status); // delete the object
-
-			// after 10 seconds complete, exit the orientation detection and display the text "Check your mobile for the result"
-			lv_obj_t * check_mobile_label = lv_label_create(lv_scr_act());
-			lv_label_set_text(check_mobile_label, "Check your mobile\n for the result");
-			lv_obj_align(check_mobile_label, LV_ALIGN_CENTER, 0, 0); // align on the center of the screen
-
-			lv_task_handler();
-			display_blanking_off(display_dev);
-
-			k_sleep(K_MSEC(5000));// delay 5 seconds
-			lv_obj_del(check_mobile_label); // delete the object
-			lv_obj_clean(lv_scr_act()); // Clear the screen
-			break; // exit the loop
-		}
-		lv_task_handler();
-		display_blanking_off(display_dev);
-
-		lv_obj_del(slider); // delete the object
-		lv_obj_del(label); // delete the object
-		lv_obj_del(count2_label); // delete the object
-		lv_obj_del(obj_cairdio_logo); // delete the object
-		lv_obj_del(obj_bluetooth_status); // delete the object
-		lv_obj_del(obj_battery_status); // delete the object
-        
-        k_sleep(K_MSEC(10));
-    } // end of while loop.
+	// splash -> menu -> tracking -> result
+	app_run(display_dev);
 
     return 0;
 }
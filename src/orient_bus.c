@@ -0,0 +1,144 @@
+/**
+ * @brief This is the orient_bus.c source code of the application. Fan-out of timestamped orientation frames to many consumers.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file orient_bus.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page orient_bus_page Orientation Bus
+ * @brief The acquisition thread is the only publisher. Frames go into a ring of
+ * CONFIG_ORIENT_BUS_DEPTH entries and orient_chan only carries the newest sequence number, so
+ * publishing is a copy and a notification whatever the number of consumers. Every consumer owns
+ * an orient_reader and copies frames out of the ring at its own pace: zbus subscribers when
+ * notified, the UI thread once per frame it renders. A slow consumer only loses its own oldest
+ * frames, counted as drops.
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include "orient_bus.h"
+
+// ------------------ Macros ------------------
+
+BUILD_ASSERT(CONFIG_ORIENT_BUS_DEPTH >= 3, "The ring needs room for the frame being written");
+
+#define ORIENT_BUS_READABLE (CONFIG_ORIENT_BUS_DEPTH - 2) ///< Frames that can be read safely behind the newest one
+
+// ------------------ Variables ------------------
+
+ZBUS_OBS_DECLARE(imu_rec_sub, tracker_sub);
+
+ZBUS_CHAN_DEFINE(orient_chan,            /* Name */
+                 struct orient_msg,      /* Message type */
+                 NULL,                   /* Validator */
+                 NULL,                   /* User data */
+                 ZBUS_OBSERVERS(imu_rec_sub, tracker_sub), /* Observers */
+                 ZBUS_MSG_INIT(0)        /* Initial value */
+);
+
+static struct orient_frame ring[CONFIG_ORIENT_BUS_DEPTH];
+static atomic_t head;                   // sequence number of the newest frame, 0 before the first
+static sys_slist_t readers = SYS_SLIST_STATIC_INIT(&readers);
+static struct k_spinlock readers_lock;
+
+// ------------------ Functions ------------------
+
+int orient_bus_publish(struct orient_frame *frame)
+{
+    uint32_t seq = (uint32_t)atomic_get(&head) + 1;
+    struct orient_msg msg = {
+        .seq = seq,
+        .t_us = frame->sample.t_us,
+    };
+
+    frame->seq = seq;
+    ring[seq % CONFIG_ORIENT_BUS_DEPTH] = *frame;
+    atomic_set(&head, seq); // full barrier, readers see the frame before the new head
+
+    return zbus_chan_pub(&orient_chan, &msg, K_NO_WAIT);
+}
+
+void orient_bus_reader_init(struct orient_reader *reader, const char *name)
+{
+    k_spinlock_key_t key = k_spin_lock(&readers_lock);
+
+    *reader = (struct orient_reader){ .name = name };
+    orient_bus_reader_sync(reader);
+    sys_slist_append(&readers, &reader->node);
+
+    k_spin_unlock(&readers_lock, key);
+}
+
+void orient_bus_reader_sync(struct orient_reader *reader)
+{
+    reader->next = (uint32_t)atomic_get(&head) + 1;
+}
+
+int orient_bus_read(struct orient_reader *reader, struct orient_frame *frame)
+{
+    while (true) {
+        uint32_t newest = (uint32_t)atomic_get(&head);
+        uint32_t oldest = newest - ORIENT_BUS_READABLE + 1;
+
+        if ((int32_t)(reader->next - newest) > 0) {
+            return -EAGAIN;
+        }
+        if ((int32_t)(oldest - reader->next) > 0) {
+            reader->drops += oldest - reader->next;
+            reader->next = oldest;
+        }
+        reader->lag_max = MAX(reader->lag_max, newest - reader->next);
+
+        *frame = ring[reader->next % CONFIG_ORIENT_BUS_DEPTH];
+
+        // the publisher may have lapped the reader during the copy
+        newest = (uint32_t)atomic_get(&head);
+        if ((int32_t)(newest - ORIENT_BUS_READABLE + 1 - reader->next) > 0) {
+            reader->drops++;
+            reader->next++;
+            continue;
+        }
+        break;
+    }
+
+    int64_t now_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+    reader->lag_us = (int32_t)CLAMP(now_us - frame->sample.t_us, INT32_MIN, INT32_MAX);
+    reader->lag_us_max = MAX(reader->lag_us_max, reader->lag_us);
+    reader->next++;
+    reader->frames++;
+    return 0;
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_orient_stats(const struct shell *sh, size_t argc, char **argv)
+{
+    struct orient_reader *r;
+
+    shell_print(sh, "published: %u", (uint32_t)atomic_get(&head));
+    SYS_SLIST_FOR_EACH_CONTAINER(&readers, r, node) {
+        shell_print(sh, "%-10s frames: %u, drops: %u, lag max: %u frames, age last: %d us, max: %d us",
+                    r->name, r->frames, r->drops, r->lag_max, r->lag_us, r->lag_us_max);
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_orient,
+    SHELL_CMD(stats, NULL, "Per-consumer frame, drop and lag counters", cmd_orient_stats),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(orient, &sub_orient, "Orientation frame bus", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
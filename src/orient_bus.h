@@ -0,0 +1,102 @@
+/**
+ * @brief This is the orient_bus.h header of the application. Fan-out of timestamped orientation frames to many consumers.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file orient_bus.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef ORIENT_BUS_H_
+#define ORIENT_BUS_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/zbus/zbus.h>
+#include "imu.h"
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief One fused orientation frame.
+ */
+struct orient_frame {
+    uint32_t seq;             ///< Publication sequence number, starts at 1
+    struct imu_sample sample; ///< Bias corrected sample, t_us on the system clock
+    float roll;               ///< Rotation about X, rad
+    float pitch;              ///< Rotation about Y, rad
+};
+
+/**
+ * @brief Message of orient_chan: the newest frame, which is read from the ring by reference.
+ */
+struct orient_msg {
+    uint32_t seq;   ///< Sequence number of the newest frame
+    int64_t t_us;   ///< Its timestamp, microseconds
+};
+
+/**
+ * @brief Per-consumer read position and counters.
+ */
+struct orient_reader {
+    sys_snode_t node;
+    const char *name;
+    uint32_t next;      ///< Sequence number of the next frame to read
+    uint32_t frames;    ///< Frames read
+    uint32_t drops;     ///< Frames overwritten before they were read
+    uint32_t lag_max;   ///< Largest backlog seen, frames
+    int32_t lag_us;     ///< Age of the last frame read, microseconds
+    int32_t lag_us_max; ///< Largest age of a frame read, microseconds
+};
+
+// ------------------ Variables ------------------
+
+/**
+ * @brief Published on every new frame. Subscribers wake up on it and drain their reader, so a
+ * missed notification loses no frames.
+ */
+ZBUS_CHAN_DECLARE(orient_chan);
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Publish a frame: copy it into the ring and notify the orient_chan observers.
+ *
+ * Never blocks, a consumer that falls more than CONFIG_ORIENT_BUS_DEPTH frames behind loses
+ * the oldest ones.
+ *
+ * @param frame Frame to publish, its seq is assigned here.
+ * @return int 0 on success, negative error code if an observer could not be notified.
+ */
+int orient_bus_publish(struct orient_frame *frame);
+
+/**
+ * @brief Register a consumer, it reads the frames published from now on.
+ *
+ * @param reader Reader instance, must stay valid.
+ * @param name Name shown by the "orient stats" shell command.
+ */
+void orient_bus_reader_init(struct orient_reader *reader, const char *name);
+
+/**
+ * @brief Skip the backlog: the next read returns the frame published after this call.
+ *
+ * @param reader Reader instance.
+ */
+void orient_bus_reader_sync(struct orient_reader *reader);
+
+/**
+ * @brief Copy the next unread frame, oldest first.
+ *
+ * @param reader Reader instance.
+ * @param frame Frame to fill in.
+ * @return int 0 on success, -EAGAIN if no new frame was published.
+ */
+int orient_bus_read(struct orient_reader *reader, struct orient_frame *frame);
+
+#endif /* ORIENT_BUS_H_ */
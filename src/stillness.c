@@ -0,0 +1,111 @@
+/**
+ * @brief This is the stillness.c source code of the application. Sliding-window stillness and tilt detector.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file stillness.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include "stillness.h"
+
+// ------------------ Functions ------------------
+
+void stillness_init_default(struct stillness *s)
+{
+    const struct stillness_config cfg = {
+        .window = CONFIG_STILLNESS_WINDOW,
+        .level_enter = CONFIG_STILLNESS_LEVEL_ENTER_MMS2 / 1000.0f,
+        .level_exit = CONFIG_STILLNESS_LEVEL_EXIT_MMS2 / 1000.0f,
+        .std_max = CONFIG_STILLNESS_STD_MAX_MMS2 / 1000.0f,
+        .dwell_us = CONFIG_STILLNESS_DWELL_MS * 1000U,
+    };
+
+    stillness_init(s, &cfg);
+}
+
+void stillness_init(struct stillness *s, const struct stillness_config *cfg)
+{
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    s->cfg.window = CLAMP(cfg->window, 1, CONFIG_STILLNESS_WINDOW_MAX);
+    s->state = STILLNESS_HOLD;
+    s->candidate = STILLNESS_HOLD;
+}
+
+/**
+ * @brief Classify the current window, with hysteresis on the tilt bands.
+ */
+static enum stillness_state stillness_classify(const struct stillness *s)
+{
+    bool tilted = (s->state == STILLNESS_TILT_NEG || s->state == STILLNESS_TILT_POS);
+    float threshold = tilted ? s->cfg.level_enter : s->cfg.level_exit;
+
+    if (s->mean < -threshold) {
+        return STILLNESS_TILT_NEG;
+    }
+    if (s->mean > threshold) {
+        return STILLNESS_TILT_POS;
+    }
+    if (s->m2 > s->cfg.std_max * s->cfg.std_max * s->count) {
+        return STILLNESS_MOVING;
+    }
+    return STILLNESS_HOLD;
+}
+
+enum stillness_state stillness_update(struct stillness *s, int32_t value, uint32_t t_us)
+{
+    float x = value * 1e-6f;
+    uint16_t tail = (s->head + s->count) % s->cfg.window;
+
+    // Welford update while the window fills, then the sliding form which adds the new value
+    // and removes the oldest one in the same step.
+    if (s->count < s->cfg.window) {
+        float delta = x - s->mean;
+
+        s->count++;
+        s->mean += delta / s->count;
+        s->m2 += delta * (x - s->mean);
+        s->win[tail] = x;
+    } else {
+        float old = s->win[s->head];
+        float mean = s->mean + (x - old) / s->count;
+
+        s->m2 += (x - old) * (x - mean + old - s->mean);
+        s->mean = mean;
+        s->win[s->head] = x;
+        s->head = (s->head + 1) % s->cfg.window;
+    }
+    if (s->m2 < 0.0f) {
+        s->m2 = 0.0f; // rounding
+    }
+
+    enum stillness_state raw = stillness_classify(s);
+
+    if (raw == s->state) {
+        s->candidate = raw;
+    } else if (raw != s->candidate) {
+        s->candidate = raw;
+        s->candidate_since = t_us;
+    } else if (t_us - s->candidate_since >= s->cfg.dwell_us) {
+        s->state = raw;
+        s->changes++;
+    }
+
+    return s->state;
+}
+
+float stillness_std(const struct stillness *s)
+{
+    return s->count ? sqrtf(s->m2 / s->count) : 0.0f;
+}
+
+// ------------------------ End of File ------------------------
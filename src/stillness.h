@@ -0,0 +1,94 @@
+/**
+ * @brief This is the stillness.h header of the application. Sliding-window stillness and tilt detector.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file stillness.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef STILLNESS_H_
+#define STILLNESS_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Debounced hold state reported by the detector.
+ */
+enum stillness_state {
+    STILLNESS_HOLD,     ///< Level and still
+    STILLNESS_MOVING,   ///< Level, but the window variance is too high
+    STILLNESS_TILT_NEG, ///< Tilted towards the negative axis
+    STILLNESS_TILT_POS, ///< Tilted towards the positive axis
+};
+
+/**
+ * @brief Detector tuning.
+ */
+struct stillness_config {
+    uint16_t window;    ///< Window length, samples, at most CONFIG_STILLNESS_WINDOW_MAX
+    float level_enter;  ///< |window mean| below which a tilt ends, m/s^2
+    float level_exit;   ///< |window mean| above which a tilt starts, m/s^2
+    float std_max;      ///< Window standard deviation below which the device is still, m/s^2
+    uint32_t dwell_us;  ///< Time a new state must persist before it is reported, microseconds
+};
+
+/**
+ * @brief Detector instance.
+ */
+struct stillness {
+    struct stillness_config cfg;
+    float win[CONFIG_STILLNESS_WINDOW_MAX]; ///< Last cfg.window values
+    uint16_t head;                          ///< Index of the oldest value in win
+    uint16_t count;                         ///< Values in win
+    float mean;                             ///< Window mean
+    float m2;                               ///< Window sum of squared deviations from the mean
+    enum stillness_state state;             ///< Reported state
+    enum stillness_state candidate;         ///< State waiting for its dwell time
+    uint32_t candidate_since;               ///< Timestamp the candidate first appeared, microseconds
+    uint32_t changes;                       ///< Number of reported state changes
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Initialize the detector from the Kconfig defaults.
+ *
+ * @param s Detector instance.
+ */
+void stillness_init_default(struct stillness *s);
+
+/**
+ * @brief Initialize the detector.
+ *
+ * @param s Detector instance.
+ * @param cfg Detector tuning.
+ */
+void stillness_init(struct stillness *s, const struct stillness_config *cfg);
+
+/**
+ * @brief Add one sample of the tilt axis, at constant cost.
+ *
+ * @param s Detector instance.
+ * @param value Acceleration along the tilt axis, micro m/s^2.
+ * @param t_us Timestamp of the sample, microseconds.
+ * @return enum stillness_state The debounced state.
+ */
+enum stillness_state stillness_update(struct stillness *s, int32_t value, uint32_t t_us);
+
+/**
+ * @brief Get the window standard deviation.
+ *
+ * @param s Detector instance.
+ * @return float Standard deviation, m/s^2.
+ */
+float stillness_std(const struct stillness *s);
+
+#endif /* STILLNESS_H_ */
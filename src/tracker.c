@@ -0,0 +1,177 @@
+/**
+ * @brief This is the tracker.c source code of the application. Orientation tracking consumer feeding the UI mailbox.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file tracker.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/zbus/zbus.h>
+#include "imu_calib.h"
+#include "imu_dsp.h"
+#include "latency.h"
+#include "orient_bus.h"
+#include "stillness.h"
+#include "tracker.h"
+#include "ui_mbox.h"
+
+// ------------------ Macros ------------------
+
+LOG_MODULE_REGISTER(tracker, CONFIG_LOG_DEFAULT_LEVEL);
+
+// ------------------ Variables ------------------
+
+ZBUS_SUBSCRIBER_DEFINE(tracker_sub, CONFIG_TRACKER_SUB_QUEUE_SIZE);
+
+static struct orient_reader reader;
+static struct stillness still;
+static enum stillness_state last_state;
+static atomic_t restart;    // reset the detector before the next frame
+static atomic_t running;
+static K_MUTEX_DEFINE(frame_lock); // held while a frame is processed, see tracker_stop()
+static struct k_spinlock latest_lock;
+static struct orient_frame latest;  // newest filtered output, see tracker_latest()
+static bool latest_valid;
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Map the filtered Y acceleration to the slider: -10 m/s^2 -> 200, 0 -> 100, 10 -> 0.
+ */
+static int32_t tracker_slider_value(const struct imu_sample *sample)
+{
+    // micro m/s^2, so 10 slider steps per m/s^2
+    return CLAMP(100 - sample->acc[1] / 100000, 0, 200);
+}
+
+int32_t tracker_slider_from_frame(const struct orient_frame *frame)
+{
+    return tracker_slider_value(&frame->sample);
+}
+
+int tracker_latest(struct orient_frame *frame)
+{
+    k_spinlock_key_t key = k_spin_lock(&latest_lock);
+    int ret = latest_valid ? 0 : -EAGAIN;
+
+    if (latest_valid) {
+        *frame = latest;
+    }
+    k_spin_unlock(&latest_lock, key);
+    return ret;
+}
+
+/**
+ * @brief Keep the newest decimated output with the attitude fused from the same frame.
+ */
+static void tracker_latch(const struct orient_frame *frame, const struct imu_sample *filtered)
+{
+    k_spinlock_key_t key = k_spin_lock(&latest_lock);
+
+    latest = *frame;
+    latest.sample = *filtered;
+    latest_valid = true;
+    k_spin_unlock(&latest_lock, key);
+}
+
+static void tracker_process(const struct orient_frame *frame)
+{
+    struct imu_sample filtered[IMU_DSP_OUT_MAX];
+
+    // debounced tilt/stillness over a sliding window of Ay
+    enum stillness_state state = stillness_update(&still, frame->sample.acc[1],
+                                                  (uint32_t)frame->sample.t_us);
+
+    if (state != last_state) {
+        ui_mbox_post(UI_FIELD_ORIENT, state);
+        last_state = state;
+    }
+
+    // refine the bias offsets while the device is held still
+    if (state == STILLNESS_HOLD) {
+        imu_calib_update(&frame->sample);
+    }
+
+    // low-pass and decimate down to the UI rate
+    int n = imu_dsp_push(&frame->sample, filtered);
+
+    if (n > 0 && IS_ENABLED(CONFIG_UI_LATE_LATCH)) {
+        // the UI takes the newest output itself right before rendering
+        tracker_latch(frame, &filtered[n - 1]);
+    } else if (n > 0) {
+        ui_mbox_post(UI_FIELD_SLIDER, tracker_slider_value(&filtered[n - 1]));
+        if (IS_ENABLED(CONFIG_UI_HORIZON)) {
+            ui_mbox_post(UI_FIELD_ROLL, (int32_t)(frame->roll * 1000.0f));
+            ui_mbox_post(UI_FIELD_PITCH, (int32_t)(frame->pitch * 1000.0f));
+        }
+        latency_stamp_processed(filtered[n - 1].t_us);
+        LOG_DBG("accelerometer's Y-axis value: %d", filtered[n - 1].acc[1]);
+    }
+}
+
+/**
+ * @brief Tracker thread: woken by orient_chan, processes every frame while tracking.
+ */
+static void tracker_thread(void *p1, void *p2, void *p3)
+{
+    const struct zbus_channel *chan;
+    struct orient_frame frame;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    orient_bus_reader_init(&reader, "tracker");
+
+    while (zbus_sub_wait(&tracker_sub, &chan, K_FOREVER) == 0) {
+        if (atomic_clear(&restart)) {
+            stillness_init_default(&still);
+            last_state = STILLNESS_HOLD;
+            orient_bus_reader_sync(&reader);
+            ui_mbox_post(UI_FIELD_ORIENT, STILLNESS_HOLD);
+        }
+
+        while (orient_bus_read(&reader, &frame) == 0) {
+            k_mutex_lock(&frame_lock, K_FOREVER);
+            if (atomic_get(&running)) {
+                tracker_process(&frame);
+            }
+            k_mutex_unlock(&frame_lock);
+        }
+    }
+}
+
+K_THREAD_DEFINE(tracker_tid, CONFIG_TRACKER_STACK_SIZE, tracker_thread, NULL, NULL, NULL,
+                CONFIG_TRACKER_THREAD_PRIORITY, 0, 0);
+
+void tracker_start(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&latest_lock);
+
+    // nothing to latch until the chain outputs a block of this session
+    latest_valid = false;
+    k_spin_unlock(&latest_lock, key);
+
+    atomic_set(&restart, 1);
+    atomic_set(&running, 1);
+}
+
+void tracker_stop(void)
+{
+    atomic_set(&running, 0);
+
+    // wait for the frame in progress, nothing is posted or calibrated once this returns
+    k_mutex_lock(&frame_lock, K_FOREVER);
+    k_mutex_unlock(&frame_lock);
+}
+
+// ------------------------ End of File ------------------------
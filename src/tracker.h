@@ -0,0 +1,59 @@
+/**
+ * @brief This is the tracker.h header of the application. Orientation tracking consumer feeding the UI mailbox.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file tracker.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef TRACKER_H_
+#define TRACKER_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include "orient_bus.h"
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Start tracking: reset the detector and follow the frames published from now on.
+ *
+ * For every frame the tracker thread runs the stillness detector, the bias refinement and the
+ * filter chain, and posts the orientation class to the UI mailbox. The filtered slider value is
+ * posted as well, or kept for tracker_latest() with CONFIG_UI_LATE_LATCH.
+ */
+void tracker_start(void);
+
+/**
+ * @brief Stop tracking, frames are ignored until the next start.
+ *
+ * Waits for the frame being processed, if any: the bias offsets are not refined and no UI
+ * update is posted once this returns, so they can be saved right after. Not from an ISR.
+ */
+void tracker_stop(void);
+
+/**
+ * @brief Newest output of the filter chain, see CONFIG_UI_LATE_LATCH.
+ *
+ * The sample is the last decimated one, the roll and pitch are fused from the frame that
+ * completed its block. Read by the UI right before rendering.
+ *
+ * @param frame Filtered frame.
+ * @return int 0 on success, -EAGAIN if the chain has not output a block since tracker_start().
+ */
+int tracker_latest(struct orient_frame *frame);
+
+/**
+ * @brief Slider value of a filtered frame, from its Y acceleration.
+ *
+ * @param frame Frame from tracker_latest().
+ * @return int32_t Slider value, 0-200.
+ */
+int32_t tracker_slider_from_frame(const struct orient_frame *frame);
+
+#endif /* TRACKER_H_ */
@@ -0,0 +1,214 @@
+/**
+ * @brief This is the ui_gate.c source code of the application. Render gate skipping frames whose content did not change.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_gate.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/timing/timing.h>
+#include <lvgl.h>
+#include "latency.h"
+#include "ui_gate.h"
+#include "ui_merge.h"
+#include "ui_port.h"
+
+// ------------------ Variables ------------------
+
+// only used from the UI thread
+static struct ui_state shown;
+static struct ui_gate_stats stats;
+static int64_t transition_start;    // uptime ticks of the pending transition, 0 if none
+static void (*flush_next)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *px);
+static uint64_t flush_cycles;       // display writes of the frame being rendered
+static uint32_t flushes;            // areas written to the display
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Knob position of a slider value, pixels from the left end.
+ */
+static int32_t ui_gate_slider_px(int32_t value)
+{
+    return value * UI_SLIDER_WIDTH_PX / UI_SLIDER_MAX;
+}
+
+/**
+ * @brief Flush wrapper: flushes, then closes the pending transition measurement.
+ */
+static void ui_gate_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *px)
+{
+    // the display write is synchronous, it has completed when flush_next returns
+    bool last = lv_disp_flush_is_last(drv);
+
+    flushes++;
+    if (last) {
+        latency_stamp_rendered();
+    }
+#ifdef CONFIG_TIMING_FUNCTIONS
+    timing_t start = timing_counter_get();
+
+    flush_next(drv, area, px);
+
+    timing_t end = timing_counter_get();
+
+    flush_cycles += timing_cycles_get(&start, &end);
+#else
+    flush_next(drv, area, px);
+#endif
+    if (last) {
+        latency_stamp_flushed();
+    }
+
+    // the first pixels of the new screen are on the display now
+    if (transition_start != 0) {
+        int64_t us = k_ticks_to_us_floor64(k_uptime_ticks() - transition_start);
+
+        stats.transition_us = (uint32_t)MIN(us, UINT32_MAX);
+        stats.transition_us_max = MAX(stats.transition_us_max, stats.transition_us);
+        stats.transitions++;
+        transition_start = 0;
+    }
+}
+
+void ui_gate_init(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+
+    if (disp == NULL || flush_next != NULL) {
+        return;
+    }
+    flush_next = disp->driver->flush_cb;
+    disp->driver->flush_cb = ui_gate_flush;
+#ifdef CONFIG_TIMING_FUNCTIONS
+    timing_init();
+    timing_start();
+#endif
+}
+
+void ui_gate_transition(void)
+{
+    transition_start = MAX(k_uptime_ticks(), 1);
+}
+
+void ui_gate_reset(const struct ui_state *state)
+{
+    shown = *state;
+}
+
+uint32_t ui_gate_filter(const struct ui_state *state, uint32_t changed)
+{
+    uint32_t visible = 0;
+
+    for (int f = 0; f < UI_FIELD_COUNT; f++) {
+        if (!(changed & BIT(f))) {
+            continue;
+        }
+
+        bool differs = (f == UI_FIELD_SLIDER) ?
+                       ui_gate_slider_px(state->value[f]) != ui_gate_slider_px(shown.value[f]) :
+                       state->value[f] != shown.value[f];
+
+        if (differs) {
+            shown.value[f] = state->value[f];
+            visible |= BIT(f);
+        } else {
+            stats.filtered++;
+        }
+    }
+    return visible;
+}
+
+bool ui_gate_render(void)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+
+#ifdef CONFIG_UI_PORT
+    ui_port_update();
+#endif
+
+    // nothing invalidated and nothing moving: the last flushed frame is still valid
+    if (disp->inv_p == 0 && lv_anim_count_running() == 0) {
+        stats.skipped++;
+        return false;
+    }
+
+    // LVGL only draws when its refresh timer is due, a run in between just advances its timers
+    bool due = ui_gate_refresh_due();
+    uint32_t flushed = flushes;
+
+#ifdef CONFIG_UI_AREA_MERGE
+    // the areas invalidated so far are the ones this refresh draws
+    if (due) {
+        ui_merge_areas(disp);
+    }
+#endif
+
+#ifdef CONFIG_TIMING_FUNCTIONS
+    timing_t start = timing_counter_get();
+
+    flush_cycles = 0;
+    lv_task_handler();
+
+    timing_t end = timing_counter_get();
+    uint64_t cycles = timing_cycles_get(&start, &end);
+#else
+    lv_task_handler();
+#endif
+
+    if (!due && flushes == flushed) {
+        stats.waited++;
+        return true;
+    }
+    stats.rendered++;
+#ifdef CONFIG_TIMING_FUNCTIONS
+    stats.draw_cycles = (uint32_t)MIN(cycles - MIN(flush_cycles, cycles), UINT32_MAX);
+    stats.draw_cycles_max = MAX(stats.draw_cycles_max, stats.draw_cycles);
+    stats.draw_cycles_total += stats.draw_cycles;
+#endif
+    return true;
+}
+
+bool ui_gate_refresh_due(void)
+{
+    lv_timer_t *refr = lv_disp_get_default()->refr_timer;
+
+    return lv_tick_elaps(refr->last_run) >= refr->period;
+}
+
+void ui_gate_get_stats(struct ui_gate_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_ui_render(const struct shell *sh, size_t argc, char **argv)
+{
+    struct ui_gate_stats s;
+
+    ui_gate_get_stats(&s);
+    shell_print(sh, "rendered: %u, skipped: %u, waited: %u, updates filtered: %u", s.rendered,
+                s.skipped, s.waited, s.filtered);
+    shell_print(sh, "transitions: %u, last: %u us, max: %u us", s.transitions, s.transition_us,
+                s.transition_us_max);
+#ifdef CONFIG_TIMING_FUNCTIONS
+    shell_print(sh, "draw cycles per frame: last %u, avg %llu, max %u", s.draw_cycles,
+                (unsigned long long)(s.rendered ? s.draw_cycles_total / s.rendered : 0), s.draw_cycles_max);
+#endif
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ui), render, NULL, "Render gate and screen transition statistics", cmd_ui_render, 1, 0);
+#endif
+
+// ------------------------ End of File ------------------------
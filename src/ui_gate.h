@@ -0,0 +1,105 @@
+/**
+ * @brief This is the ui_gate.h header of the application. Render gate skipping frames whose content did not change.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_gate.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_GATE_H_
+#define UI_GATE_H_
+
+// ------------------ Includes ------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ui_mbox.h"
+
+// ------------------ Macros ------------------
+
+#define UI_SLIDER_MAX       200 ///< Slider range is 0 to UI_SLIDER_MAX
+#define UI_SLIDER_WIDTH_PX  200 ///< Slider width on screen, pixels
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Render gate statistics.
+ */
+struct ui_gate_stats {
+    uint32_t rendered;  ///< Frames LVGL drew: its refresh was due or areas were flushed
+    uint32_t skipped;   ///< Frames with nothing to redraw, LVGL and the SPI bus left idle
+    uint32_t waited;    ///< Frames LVGL ran before its refresh was due, nothing drawn yet
+    uint32_t filtered;  ///< Field updates dropped as visually identical to the displayed state
+    uint32_t transitions;       ///< Screen transitions measured
+    uint32_t transition_us;     ///< Last transition, trigger to first area written to the display, microseconds
+    uint32_t transition_us_max; ///< Slowest transition, microseconds
+    uint32_t draw_cycles;       ///< Last rendered frame, cycles LVGL spent drawing, display writes excluded
+    uint32_t draw_cycles_max;   ///< Slowest frame to draw, cycles
+    uint64_t draw_cycles_total; ///< All rendered frames, cycles, the average is over rendered
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Hook the display flush to timestamp the first area written after a transition.
+ *
+ * Call once, after LVGL and its display driver are initialized.
+ */
+void ui_gate_init(void);
+
+/**
+ * @brief Start measuring a screen transition, call when it is triggered.
+ */
+void ui_gate_transition(void);
+
+/**
+ * @brief Restart the gate from a freshly drawn screen.
+ *
+ * @param shown State the screen has just been drawn with.
+ */
+void ui_gate_reset(const struct ui_state *shown);
+
+/**
+ * @brief Keep only the field updates that change what is on screen.
+ *
+ * The slider counts as changed once its knob moves at least one pixel, the other fields when
+ * their value differs from the displayed one. The kept fields become the displayed state.
+ *
+ * @param state Latest UI state.
+ * @param changed Mask of the fields updated since the last frame, BIT(enum ui_field).
+ * @return uint32_t Mask of the fields to apply to the widgets.
+ */
+uint32_t ui_gate_filter(const struct ui_state *state, uint32_t changed);
+
+/**
+ * @brief Run LVGL only if an area is invalidated or an animation is running.
+ *
+ * With CONFIG_TIMING_FUNCTIONS the cycles spent drawing the frame are measured, the display
+ * writes from the flush callback are left out.
+ *
+ * @return true if LVGL ran this frame, false if the frame was skipped. LVGL may run without
+ * drawing until its refresh period elapses, keep calling at the frame rate while true.
+ */
+bool ui_gate_render(void);
+
+/**
+ * @brief Check if the next LVGL run refreshes the display, i.e. its refresh period has elapsed.
+ *
+ * State latched right before such a run is drawn at once.
+ *
+ * @return true if the refresh is due.
+ */
+bool ui_gate_refresh_due(void);
+
+/**
+ * @brief Get the render gate statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void ui_gate_get_stats(struct ui_gate_stats *stats);
+
+#endif /* UI_GATE_H_ */
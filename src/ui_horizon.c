@@ -0,0 +1,208 @@
+/**
+ * @brief This is the ui_horizon.c source code of the application. Artificial horizon drawn as per-row spans.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_horizon.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_horizon_page Artificial Horizon
+ * @brief A straight horizon splits every row of the display into at most one ground span and
+ * sky around it. The widget keeps the span of each row, fills the rows of the draw buffer
+ * with two colors, and on an attitude update invalidates only the columns between the old
+ * and new split of the rows that changed. Changed rows are merged per band of
+ * CONFIG_UI_HORIZON_BAND_ROWS, so a rotation stays within LVGL's invalidated area list and
+ * is sent as a few narrow SPI bursts along the line instead of the whole screen.
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include "ui_horizon.h"
+
+// ------------------ Variables ------------------
+
+static struct ui_horizon_stats stats; // UI thread only
+
+// ------------------ Functions ------------------
+
+static inline lv_color_t ui_horizon_sky(void)
+{
+    return lv_color_hex(0x1E5AA8);
+}
+
+static inline lv_color_t ui_horizon_ground(void)
+{
+    return lv_color_hex(0x7A4A1E);
+}
+
+/**
+ * @brief Fill the clipped rows of the draw buffer with their spans, nothing else is drawn.
+ */
+static void ui_horizon_draw(struct ui_horizon *h, lv_draw_ctx_t *draw_ctx)
+{
+    const lv_area_t *buf_area = draw_ctx->buf_area;
+    lv_coord_t stride = lv_area_get_width(buf_area);
+    lv_color_t *buf = draw_ctx->buf;
+    lv_color_t sky = ui_horizon_sky();
+    lv_color_t ground = ui_horizon_ground();
+    lv_area_t coords;
+    lv_area_t clip;
+
+    lv_obj_get_coords(h->obj, &coords);
+    if (!_lv_area_intersect(&clip, draw_ctx->clip_area, &coords)) {
+        return;
+    }
+
+    for (lv_coord_t y = clip.y1; y <= clip.y2; y++) {
+        const struct ui_horizon_span *span = &h->row[y - coords.y1];
+        lv_color_t *dst = buf + (int32_t)(y - buf_area->y1) * stride + (clip.x1 - buf_area->x1);
+        lv_coord_t x0 = CLAMP(coords.x1 + span->x0, clip.x1, clip.x2 + 1);
+        lv_coord_t x1 = CLAMP(coords.x1 + span->x1, clip.x1, clip.x2 + 1);
+
+        lv_color_fill(dst, sky, x0 - clip.x1);
+        lv_color_fill(dst + (x0 - clip.x1), ground, x1 - x0);
+        lv_color_fill(dst + (x1 - clip.x1), sky, clip.x2 + 1 - x1);
+    }
+}
+
+static void ui_horizon_event(lv_event_t *e)
+{
+    struct ui_horizon *h = lv_event_get_user_data(e);
+    lv_event_code_t code = lv_event_get_code(e);
+
+    if (code == LV_EVENT_COVER_CHECK) {
+        lv_cover_check_info_t *info = lv_event_get_param(e);
+
+        // opaque, LVGL draws nothing underneath
+        if (info->res != LV_COVER_RES_MASKED && _lv_area_is_in(info->area, &h->obj->coords, 0)) {
+            info->res = LV_COVER_RES_COVER;
+        }
+    } else if (code == LV_EVENT_DRAW_MAIN) {
+        ui_horizon_draw(h, lv_event_get_draw_ctx(e));
+    }
+}
+
+/**
+ * @brief Columns that differ between two ground spans, as [x0, x1).
+ */
+static struct ui_horizon_span ui_horizon_diff(struct ui_horizon_span a, struct ui_horizon_span b)
+{
+    if (a.x0 == a.x1) {
+        return b;
+    }
+    if (b.x0 == b.x1) {
+        return a;
+    }
+    if (a.x0 == b.x0) {
+        return (struct ui_horizon_span){MIN(a.x1, b.x1), MAX(a.x1, b.x1)};
+    }
+    if (a.x1 == b.x1) {
+        return (struct ui_horizon_span){MIN(a.x0, b.x0), MAX(a.x0, b.x0)};
+    }
+    return (struct ui_horizon_span){MIN(a.x0, b.x0), MAX(a.x1, b.x1)};
+}
+
+void ui_horizon_create(struct ui_horizon *h, lv_obj_t *parent)
+{
+    h->obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(h->obj);
+    lv_obj_set_size(h->obj, UI_HORIZON_WIDTH, UI_HORIZON_HEIGHT);
+    lv_obj_center(h->obj);
+    lv_obj_clear_flag(h->obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_move_background(h->obj);
+    lv_obj_add_event_cb(h->obj, ui_horizon_event, LV_EVENT_ALL, h);
+
+    // all sky, so the first update sets every row
+    memset(h->row, 0, sizeof(h->row));
+    ui_horizon_set(h, 0, 0);
+}
+
+void ui_horizon_set(struct ui_horizon *h, int32_t roll_mrad, int32_t pitch_mrad)
+{
+    float roll = roll_mrad * 1e-3f;
+    float s = sinf(roll);
+    float c = cosf(roll);
+    float off = pitch_mrad * 1e-3f * UI_HORIZON_PX_PER_RAD;
+    bool vertical_split = fabsf(s) > 1e-4f;
+    float inv_s = vertical_split ? 1.0f / s : 0.0f;
+    lv_area_t coords;
+
+    lv_obj_get_coords(h->obj, &coords);
+    stats.updates++;
+
+    for (int y0 = 0; y0 < UI_HORIZON_HEIGHT; y0 += CONFIG_UI_HORIZON_BAND_ROWS) {
+        int y_end = MIN(y0 + CONFIG_UI_HORIZON_BAND_ROWS, UI_HORIZON_HEIGHT);
+        lv_area_t band = {.x1 = INT16_MAX, .y1 = INT16_MAX, .x2 = -1, .y2 = -1};
+
+        for (int y = y0; y < y_end; y++) {
+            // ground where dy * cos(roll) + dx * sin(roll) > off, from the pixel centers
+            float dy = y + 0.5f - UI_HORIZON_HEIGHT / 2.0f;
+            struct ui_horizon_span span;
+
+            if (vertical_split) {
+                float x = UI_HORIZON_WIDTH / 2.0f + (off - dy * c) * inv_s;
+                int16_t split = (int16_t)CLAMP(lroundf(x), 0, UI_HORIZON_WIDTH);
+
+                span = (s > 0.0f) ? (struct ui_horizon_span){split, UI_HORIZON_WIDTH} :
+                                    (struct ui_horizon_span){0, split};
+            } else {
+                span = (struct ui_horizon_span){0, (dy * c > off) ? UI_HORIZON_WIDTH : 0};
+            }
+            if (span.x0 == span.x1) {
+                span = (struct ui_horizon_span){0, 0};
+            }
+
+            struct ui_horizon_span diff = ui_horizon_diff(h->row[y], span);
+
+            if (diff.x0 == diff.x1) {
+                continue;
+            }
+            h->row[y] = span;
+            band.x1 = MIN(band.x1, diff.x0);
+            band.x2 = MAX(band.x2, diff.x1 - 1);
+            band.y1 = MIN(band.y1, y);
+            band.y2 = y;
+            stats.rows++;
+        }
+
+        if (band.y2 < 0) {
+            continue;
+        }
+        stats.areas++;
+        stats.pixels += lv_area_get_size(&band);
+        lv_area_move(&band, coords.x1, coords.y1);
+        lv_obj_invalidate_area(h->obj, &band);
+    }
+}
+
+void ui_horizon_get_stats(struct ui_horizon_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#if defined(CONFIG_SHELL) && defined(CONFIG_UI_HORIZON)
+static int cmd_ui_horizon(const struct shell *sh, size_t argc, char **argv)
+{
+    struct ui_horizon_stats s;
+
+    ui_horizon_get_stats(&s);
+    shell_print(sh, "updates: %u, rows changed: %u, areas: %u, pixels: %u (%u per update)", s.updates,
+                s.rows, s.areas, s.pixels, s.updates ? s.pixels / s.updates : 0);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ui), horizon, NULL, "Artificial horizon redrawn rows and pixels", cmd_ui_horizon, 1, 0);
+#endif
+
+// ------------------------ End of File ------------------------
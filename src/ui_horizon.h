@@ -0,0 +1,84 @@
+/**
+ * @brief This is the ui_horizon.h header of the application. Artificial horizon drawn as per-row spans.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_horizon.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_HORIZON_H_
+#define UI_HORIZON_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <zephyr/devicetree.h>
+#include <lvgl.h>
+
+// ------------------ Macros ------------------
+
+#define UI_HORIZON_WIDTH    DT_PROP(DT_CHOSEN(zephyr_display), width)  ///< Pixels
+#define UI_HORIZON_HEIGHT   DT_PROP(DT_CHOSEN(zephyr_display), height) ///< Pixels, one span per row
+#define UI_HORIZON_PX_PER_RAD 153 ///< Horizon shift per radian of pitch, 45 degrees reach the display edge
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Ground span of one row, [x0, x1) from the left edge, empty if x0 == x1. The rest is sky.
+ */
+struct ui_horizon_span {
+    int16_t x0;
+    int16_t x1;
+};
+
+/**
+ * @brief Horizon widget, a full-screen LVGL object drawing its spans straight into the draw buffer.
+ */
+struct ui_horizon {
+    lv_obj_t *obj;
+    struct ui_horizon_span row[UI_HORIZON_HEIGHT];
+};
+
+/**
+ * @brief Span renderer statistics.
+ */
+struct ui_horizon_stats {
+    uint32_t updates;   ///< Attitude updates
+    uint32_t rows;      ///< Rows whose span changed
+    uint32_t areas;     ///< Areas invalidated, one per band of CONFIG_UI_HORIZON_BAND_ROWS with changes
+    uint32_t pixels;    ///< Pixels invalidated, i.e. redrawn and sent to the display
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Create the horizon, level, as the bottom-most child of a screen.
+ *
+ * @param h Widget to create.
+ * @param parent Screen to build on, the horizon covers it.
+ */
+void ui_horizon_create(struct ui_horizon *h, lv_obj_t *parent);
+
+/**
+ * @brief Move the horizon, invalidating only the rows whose span changed.
+ *
+ * Positive roll turns the horizon counter-clockwise, positive pitch moves it down.
+ *
+ * @param h Widget.
+ * @param roll_mrad Roll, milli rad.
+ * @param pitch_mrad Pitch, milli rad.
+ */
+void ui_horizon_set(struct ui_horizon *h, int32_t roll_mrad, int32_t pitch_mrad);
+
+/**
+ * @brief Get the span renderer statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void ui_horizon_get_stats(struct ui_horizon_stats *stats);
+
+#endif /* UI_HORIZON_H_ */
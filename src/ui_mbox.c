@@ -0,0 +1,87 @@
+/**
+ * @brief This is the ui_mbox.c source code of the application. Latest-value-wins mailbox for UI state updates from any thread.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_mbox.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include "ui_mbox.h"
+
+// ------------------ Variables ------------------
+
+static struct k_spinlock mbox_lock;
+static int32_t pending[UI_FIELD_COUNT];
+static uint32_t dirty;
+static struct ui_mbox_stats stats;
+
+// ------------------ Functions ------------------
+
+void ui_mbox_post(enum ui_field field, int32_t value)
+{
+    k_spinlock_key_t key = k_spin_lock(&mbox_lock);
+
+    if (dirty & BIT(field)) {
+        stats.coalesced++;
+    }
+    pending[field] = value;
+    dirty |= BIT(field);
+    stats.posts++;
+
+    k_spin_unlock(&mbox_lock, key);
+}
+
+uint32_t ui_mbox_take(struct ui_state *state)
+{
+    k_spinlock_key_t key = k_spin_lock(&mbox_lock);
+    uint32_t changed = dirty;
+
+    for (int f = 0; f < UI_FIELD_COUNT; f++) {
+        if (changed & BIT(f)) {
+            state->value[f] = pending[f];
+        }
+    }
+    dirty = 0;
+    if (changed) {
+        stats.batches++;
+    }
+
+    k_spin_unlock(&mbox_lock, key);
+    return changed;
+}
+
+void ui_mbox_get_stats(struct ui_mbox_stats *out)
+{
+    k_spinlock_key_t key = k_spin_lock(&mbox_lock);
+
+    *out = stats;
+    k_spin_unlock(&mbox_lock, key);
+}
+
+// ------------------ Shell Commands ------------------
+
+#ifdef CONFIG_SHELL
+static int cmd_ui_mbox(const struct shell *sh, size_t argc, char **argv)
+{
+    struct ui_mbox_stats s;
+
+    ui_mbox_get_stats(&s);
+    shell_print(sh, "posts: %u, coalesced: %u, batches applied: %u", s.posts, s.coalesced, s.batches);
+    return 0;
+}
+
+// the UI modules add their own statistics to the set with SHELL_SUBCMD_ADD((ui), ...)
+SHELL_SUBCMD_SET_CREATE(sub_ui, (ui));
+SHELL_SUBCMD_ADD((ui), mbox, NULL, "UI update mailbox statistics", cmd_ui_mbox, 1, 0);
+SHELL_CMD_REGISTER(ui, &sub_ui, "User interface", NULL);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,81 @@
+/**
+ * @brief This is the ui_mbox.h header of the application. Latest-value-wins mailbox for UI state updates from any thread.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_mbox.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_MBOX_H_
+#define UI_MBOX_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief UI state fields, one bit each in the changed mask.
+ */
+enum ui_field {
+    UI_FIELD_SLIDER,    ///< Slider value, 0-200
+    UI_FIELD_ORIENT,    ///< Orientation class, enum stillness_state
+    UI_FIELD_COUNTDOWN, ///< Remaining hold time, seconds
+    UI_FIELD_BATTERY,   ///< Battery level, percent
+    UI_FIELD_BLE,       ///< BLE connected, 0 or 1
+    UI_FIELD_ROLL,      ///< Roll, milli rad
+    UI_FIELD_PITCH,     ///< Pitch, milli rad
+    UI_FIELD_PROGRESS,  ///< Hold progress, 0 to UI_RING_MAX
+    UI_FIELD_COUNT,
+};
+
+/**
+ * @brief Latest value of every field.
+ */
+struct ui_state {
+    int32_t value[UI_FIELD_COUNT];
+};
+
+/**
+ * @brief Mailbox statistics.
+ */
+struct ui_mbox_stats {
+    uint32_t posts;     ///< Updates posted
+    uint32_t coalesced; ///< Updates overwritten before the UI applied them
+    uint32_t batches;   ///< Non-empty batches taken by the UI
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Post a field update, from any thread or ISR. Never blocks.
+ *
+ * An update not yet applied by the UI is overwritten in place, so a burst of updates costs
+ * one redraw.
+ *
+ * @param field Field to update.
+ * @param value New value.
+ */
+void ui_mbox_post(enum ui_field field, int32_t value);
+
+/**
+ * @brief Take all pending updates, from the UI thread once per frame.
+ *
+ * @param state State to bring up to date, fields not posted since the last call are kept.
+ * @return uint32_t Mask of the changed fields, BIT(enum ui_field).
+ */
+uint32_t ui_mbox_take(struct ui_state *state);
+
+/**
+ * @brief Get the mailbox statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void ui_mbox_get_stats(struct ui_mbox_stats *stats);
+
+#endif /* UI_MBOX_H_ */
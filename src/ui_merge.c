@@ -0,0 +1,165 @@
+/**
+ * @brief This is the ui_merge.c source code of the application. Invalidated area merging driven by the display bus cost.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_merge.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_merge_page Area Merge Policy
+ * @brief Every area LVGL draws is sent to the GC9A01 as its own window: CASET and RASET with
+ * four parameter bytes each and RAMWR, six SPI transactions with a DC toggle before each,
+ * then the pixels. LVGL joins two areas only when their bounding box is smaller than both
+ * together, so a knob, a label and a status icon cost three windows while two nearby labels
+ * that do not overlap are never joined, however cheap their gap is to send.
+ *
+ * The policy prices an area as its window overhead, once per draw buffer band LVGL cuts it
+ * into, plus two bytes per pixel, and merges the pair whose bounding box saves the most until
+ * no merge saves anything. The overhead is set in Kconfig (CONFIG_UI_AREA_MERGE_*): command
+ * bytes, DC toggles per window, and the bus time of one toggle with its transaction setup in
+ * byte times. With debug logging each merge and the per frame result are logged for tuning,
+ * "ui merge" shows the totals.
+ */
+
+// ------------------ Includes ------------------
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include "ui_merge.h"
+
+LOG_MODULE_REGISTER(ui_merge, CONFIG_LOG_DEFAULT_LEVEL);
+
+// ------------------ Variables ------------------
+
+static struct ui_merge_stats stats; // UI thread only
+
+// ------------------ Functions ------------------
+
+uint32_t ui_merge_cost(const lv_area_t *area, uint32_t buf_px)
+{
+    uint32_t w = lv_area_get_width(area);
+    uint32_t h = lv_area_get_height(area);
+    uint32_t band_rows = MAX(buf_px / w, 1);
+
+    return DIV_ROUND_UP(h, band_rows) * UI_MERGE_WINDOW_COST + w * h * (LV_COLOR_SIZE / 8);
+}
+
+void ui_merge_areas(lv_disp_t *disp)
+{
+    lv_area_t area[LV_INV_BUF_SIZE];
+    uint32_t cost[LV_INV_BUF_SIZE];
+    uint32_t buf_px = disp->driver->draw_buf->size;
+    uint32_t cost_in = 0;
+    uint32_t cost_out = 0;
+    int n = 0;
+
+    // a full refresh is drawn as one area anyway
+    if (disp->inv_p == 0 || disp->driver->full_refresh || disp->driver->direct_mode) {
+        return;
+    }
+
+    for (int i = 0; i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        area[n] = disp->inv_areas[i];
+        cost[n] = ui_merge_cost(&area[n], buf_px);
+        cost_in += cost[n];
+        n++;
+    }
+    stats.frames++;
+    stats.areas_in += n;
+
+    for (;;) {
+        int32_t best_gain = 0;
+        int best_i = 0;
+        int best_j = 0;
+        lv_area_t best;
+
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                lv_area_t box;
+
+                _lv_area_join(&box, &area[i], &area[j]);
+
+                int32_t gain = (int32_t)(cost[i] + cost[j]) - (int32_t)ui_merge_cost(&box, buf_px);
+
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best_i = i;
+                    best_j = j;
+                    best = box;
+                }
+            }
+        }
+        if (best_gain <= 0) {
+            break;
+        }
+
+        LOG_DBG("merge %d,%d %dx%d + %d,%d %dx%d, saves %d", area[best_i].x1, area[best_i].y1,
+                lv_area_get_width(&area[best_i]), lv_area_get_height(&area[best_i]),
+                area[best_j].x1, area[best_j].y1, lv_area_get_width(&area[best_j]),
+                lv_area_get_height(&area[best_j]), best_gain);
+        area[best_i] = best;
+        cost[best_i] = ui_merge_cost(&best, buf_px);
+        area[best_j] = area[--n];
+        cost[best_j] = cost[n];
+        stats.merges++;
+
+        // areas inside the merged box are sent with it
+        for (int k = 0; k < n; k++) {
+            if (k != best_i && _lv_area_is_in(&area[k], &best, 0)) {
+                area[k] = area[--n];
+                cost[k] = cost[n];
+                if (best_i == n) {
+                    best_i = k;
+                }
+                k--;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        cost_out += cost[i];
+    }
+    LOG_DBG("frame: %d -> %d areas, cost %u -> %u", disp->inv_p, n, cost_in, cost_out);
+    stats.areas_out += n;
+    stats.cost_in += cost_in;
+    stats.cost_out += cost_out;
+
+    memcpy(disp->inv_areas, area, n * sizeof(area[0]));
+    memset(disp->inv_area_joined, 0, sizeof(disp->inv_area_joined));
+    disp->inv_p = n;
+}
+
+void ui_merge_get_stats(struct ui_merge_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#if defined(CONFIG_SHELL) && defined(CONFIG_UI_AREA_MERGE)
+static int cmd_ui_merge(const struct shell *sh, size_t argc, char **argv)
+{
+    struct ui_merge_stats s;
+
+    ui_merge_get_stats(&s);
+    shell_print(sh, "frames: %u, areas: %u -> %u, pairs merged: %u", s.frames, s.areas_in, s.areas_out,
+                s.merges);
+    shell_print(sh, "bus cost: %llu -> %llu byte times, window: %u", (unsigned long long)s.cost_in,
+                (unsigned long long)s.cost_out, UI_MERGE_WINDOW_COST);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ui), merge, NULL, "Invalidated area merging and display bus cost", cmd_ui_merge, 1, 0);
+#endif
+
+// ------------------------ End of File ------------------------
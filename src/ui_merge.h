@@ -0,0 +1,72 @@
+/**
+ * @brief This is the ui_merge.h header of the application. Invalidated area merging driven by the display bus cost.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_merge.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_MERGE_H_
+#define UI_MERGE_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// ------------------ Macros ------------------
+
+/**
+ * @brief Bus cost of one display window (CASET, RASET, RAMWR and their DC toggles), byte times.
+ */
+#define UI_MERGE_WINDOW_COST (CONFIG_UI_AREA_MERGE_CMD_BYTES + \
+                              CONFIG_UI_AREA_MERGE_DC_TOGGLES * CONFIG_UI_AREA_MERGE_DC_TOGGLE_BYTES)
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Area merge statistics, over the refreshed frames.
+ */
+struct ui_merge_stats {
+    uint32_t frames;    ///< Frames refreshed with at least one invalidated area
+    uint32_t areas_in;  ///< Areas invalidated by the widgets
+    uint32_t areas_out; ///< Areas left after merging, each drawn and sent on its own
+    uint32_t merges;    ///< Pairs merged
+    uint64_t cost_in;   ///< Bus cost of the invalidated areas sent as they are, byte times
+    uint64_t cost_out;  ///< Bus cost after merging, byte times
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Bus cost of sending an area: its windows, one per draw buffer band, and its pixels.
+ *
+ * @param area Area on the display.
+ * @param buf_px Draw buffer size, pixels.
+ * @return uint32_t Cost, byte times.
+ */
+uint32_t ui_merge_cost(const lv_area_t *area, uint32_t buf_px);
+
+/**
+ * @brief Merge the invalidated areas of a display where sending their bounding box is cheaper.
+ *
+ * Call right before LVGL refreshes the display. Pairs are merged greedily, largest saving
+ * first, until no merge lowers the bus cost; areas inside a merged box are dropped. LVGL's
+ * own join runs after and only merges overlapping areas, which never costs more.
+ *
+ * @param disp Display about to be refreshed.
+ */
+void ui_merge_areas(lv_disp_t *disp);
+
+/**
+ * @brief Get the area merge statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void ui_merge_get_stats(struct ui_merge_stats *stats);
+
+#endif /* UI_MERGE_H_ */
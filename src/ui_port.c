@@ -0,0 +1,174 @@
+/**
+ * @brief This is the ui_port.c source code of the application. LVGL display port sized for the GC9A01.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_port.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_port_page LVGL Display Port
+ * @brief Zephyr's LVGL glue sizes its draw buffers from CONFIG_LV_Z_BITS_PER_PIXEL, 32 by
+ * default, so with 16-bit color its two 10 % buffers hold twice the pixels they were meant to
+ * and take 45 KB. The port replaces them on the default display with two buffers of exactly
+ * UI_PORT_WIDTH x CONFIG_UI_PORT_BAND_ROWS_MAX RGB565 pixels, word aligned and left out of
+ * the boot-time zeroing. Every nRF5340 RAM block is reachable by EasyDMA, so the flush hands
+ * them to display_write() as they are; a failed write is logged once and counted ("ui band").
+ * The glue's own buffers are cut to its minimum in prj.conf, so the port is always built.
+ *
+ * The rounder widens areas to an even start column and width: every band row is then a whole
+ * number of words, so the driver's word-wise byte swap never meets a misaligned word. With
+ * CONFIG_GC9A01_TILE_SHADOW areas are rounded to the driver's 16x16 tiles instead, bands
+ * included, so the driver can compare every flushed tile with the one the display shows. The
+ * band height is tunable at runtime ("ui band"), trading draw buffer use against the number
+ * of display windows per area.
+ */
+
+// ------------------ Includes ------------------
+
+#include <errno.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <lvgl.h>
+#include "ui_port.h"
+
+LOG_MODULE_REGISTER(ui_port, CONFIG_LOG_DEFAULT_LEVEL);
+
+// ------------------ Variables ------------------
+
+BUILD_ASSERT(LV_COLOR_DEPTH == 16, "the port draws RGB565");
+
+static __noinit lv_color_t draw_px[2][UI_PORT_WIDTH * UI_PORT_BAND_ROWS_MAX] __aligned(4);
+static lv_disp_draw_buf_t draw_buf;
+static const struct device *display;
+static uint32_t band_rows;
+static atomic_t band_rows_req;  // requested by the shell, 0 if none
+static uint32_t write_errors;
+static int write_error_last;
+
+// ------------------ Functions ------------------
+
+static void ui_port_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *px)
+{
+    struct display_buffer_descriptor desc = {
+        .width = lv_area_get_width(area),
+        .height = lv_area_get_height(area),
+        .pitch = lv_area_get_width(area),
+    };
+
+    desc.buf_size = desc.width * desc.height * sizeof(lv_color_t);
+    int ret = display_write(display, area->x1, area->y1, &desc, px);
+
+    // LVGL cannot retry, the area stays stale on the panel until it is redrawn
+    if (ret != 0) {
+        if (write_errors++ == 0) {
+            LOG_ERR("display write failed: %d", ret);
+        }
+        write_error_last = ret;
+    }
+    lv_disp_flush_ready(drv);
+}
+
+static void ui_port_rounder(lv_disp_drv_t *drv, lv_area_t *area)
+{
+    area->x1 &= ~(UI_PORT_ALIGN - 1);
+    area->x2 |= UI_PORT_ALIGN - 1;
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+    area->y1 &= ~(UI_PORT_ALIGN - 1);
+    area->y2 |= UI_PORT_ALIGN - 1;
+#endif
+}
+
+/**
+ * @brief Point LVGL at the first rows of both buffers.
+ */
+static void ui_port_set_draw_buf(lv_disp_drv_t *drv, uint32_t rows)
+{
+    lv_disp_draw_buf_init(&draw_buf, draw_px[0], draw_px[1], UI_PORT_WIDTH * rows);
+    drv->draw_buf = &draw_buf;
+    band_rows = rows;
+}
+
+int ui_port_init(const struct device *display_dev)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+
+    if (disp == NULL) {
+        LOG_ERR("LVGL has no display");
+        return -ENODEV;
+    }
+
+    display = display_dev;
+    ui_port_set_draw_buf(disp->driver, UI_PORT_BAND_ROWS_MAX);
+    disp->driver->flush_cb = ui_port_flush;
+    disp->driver->rounder_cb = ui_port_rounder;
+    lv_disp_drv_update(disp, disp->driver);
+    LOG_INF("draw buffers: 2 x %u bytes, %u rows", (uint32_t)sizeof(draw_px[0]), band_rows);
+    return 0;
+}
+
+int ui_port_set_band_rows(uint32_t rows)
+{
+    if (rows < UI_PORT_BAND_ROWS_MIN || rows > UI_PORT_BAND_ROWS_MAX) {
+        return -EINVAL;
+    }
+    atomic_set(&band_rows_req, rows);
+    return 0;
+}
+
+uint32_t ui_port_get_band_rows(void)
+{
+    return band_rows;
+}
+
+uint32_t ui_port_get_write_errors(void)
+{
+    return write_errors;
+}
+
+void ui_port_update(void)
+{
+    uint32_t rows = atomic_clear(&band_rows_req);
+    lv_disp_t *disp = lv_disp_get_default();
+
+    // between frames, no buffer is being drawn or flushed
+    if (rows == 0 || rows == band_rows || disp == NULL) {
+        return;
+    }
+    ui_port_set_draw_buf(disp->driver, rows);
+    LOG_INF("band: %u rows", rows);
+}
+
+// ------------------ Shell Commands ------------------
+
+#if defined(CONFIG_SHELL) && defined(CONFIG_UI_PORT)
+static int cmd_ui_band(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc > 1) {
+        uint32_t rows = strtoul(argv[1], NULL, 10);
+
+        if (ui_port_set_band_rows(rows) != 0) {
+            shell_error(sh, "rows: %u to %u", UI_PORT_BAND_ROWS_MIN, UI_PORT_BAND_ROWS_MAX);
+            return -EINVAL;
+        }
+        shell_print(sh, "band: %u rows from the next frame", rows);
+        return 0;
+    }
+    shell_print(sh, "band: %u rows of %u, %u pixels per flush", ui_port_get_band_rows(),
+                UI_PORT_BAND_ROWS_MAX, ui_port_get_band_rows() * UI_PORT_WIDTH);
+    shell_print(sh, "display write errors: %u, last: %d", ui_port_get_write_errors(),
+                write_error_last);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ui), band, NULL, "Draw buffer band height, [rows] to change it", cmd_ui_band, 1, 1);
+#endif
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,74 @@
+/**
+ * @brief This is the ui_port.h header of the application. LVGL display port sized for the GC9A01.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_port.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_PORT_H_
+#define UI_PORT_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+// ------------------ Macros ------------------
+
+#define UI_PORT_WIDTH   DT_PROP(DT_CHOSEN(zephyr_display), width)  ///< Pixels per row of a band
+#define UI_PORT_BAND_ROWS_MAX CONFIG_UI_PORT_BAND_ROWS_MAX          ///< Rows the draw buffers hold
+
+#ifdef CONFIG_GC9A01_TILE_SHADOW
+#define UI_PORT_ALIGN   16  ///< Areas are rounded to the driver's shadow tiles
+#else
+#define UI_PORT_ALIGN   2   ///< Areas are rounded to whole words per row
+#endif
+#define UI_PORT_BAND_ROWS_MIN MIN(UI_PORT_ALIGN, UI_PORT_BAND_ROWS_MAX) ///< Fewest rows a band can be rounded to
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Take over the default LVGL display: draw buffers, flush and rounder callbacks.
+ *
+ * Call once after LVGL is initialized and before ui_gate_init(), which wraps the flush.
+ *
+ * @param display_dev Display device the draw buffers are written to.
+ * @return int 0 if successful, negative errno code on failure.
+ */
+int ui_port_init(const struct device *display_dev);
+
+/**
+ * @brief Request a band height, applied by the UI thread before its next frame.
+ *
+ * @param rows Rows LVGL draws per flush, UI_PORT_BAND_ROWS_MIN to UI_PORT_BAND_ROWS_MAX.
+ * @return int 0 if successful, -EINVAL if out of range.
+ */
+int ui_port_set_band_rows(uint32_t rows);
+
+/**
+ * @brief Get the band height in use.
+ *
+ * @return uint32_t Rows LVGL draws per flush.
+ */
+uint32_t ui_port_get_band_rows(void);
+
+/**
+ * @brief Get the number of flushed areas the display failed to write.
+ *
+ * @return uint32_t display_write() errors since boot.
+ */
+uint32_t ui_port_get_write_errors(void);
+
+/**
+ * @brief Apply a requested band height, from the UI thread between frames.
+ */
+void ui_port_update(void);
+
+#endif /* UI_PORT_H_ */
@@ -0,0 +1,142 @@
+/**
+ * @brief This is the ui_ring.c source code of the application. Progress ring invalidating only the changed arc segment.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_ring.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_ring_page Progress Ring
+ * @brief The ring is drawn as two arcs, the filled part and the track after it, so no pixel is
+ * drawn twice. When the progress moves, only the bounding box of the arc between the old and
+ * the new end, rounded caps included, is invalidated: a one degree step near the display edge
+ * is a few hundred pixels instead of the ring's whole bounding box. The anti-aliased edges come
+ * from LVGL's circle cache, which holds the outer, inner and cap radii of the ring next to the
+ * other rounded widgets of the screen (CONFIG_LV_CIRCLE_CACHE_SIZE).
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include "ui_ring.h"
+
+// ------------------ Variables ------------------
+
+static struct ui_ring_stats stats; // UI thread only
+
+// ------------------ Functions ------------------
+
+static inline lv_point_t ui_ring_center(const struct ui_ring *ring)
+{
+    lv_area_t coords;
+
+    lv_obj_get_coords(ring->obj, &coords);
+    return (lv_point_t){coords.x1 + UI_RING_RADIUS, coords.y1 + UI_RING_RADIUS};
+}
+
+/**
+ * @brief Draw span degrees of the ring clockwise from start, a full turn as a closed ring.
+ */
+static void ui_ring_draw_arc(lv_draw_ctx_t *draw_ctx, const lv_draw_arc_dsc_t *dsc,
+                             const lv_point_t *center, uint16_t start, uint16_t span)
+{
+    if (span == 0) {
+        return;
+    }
+    if (span >= 360) {
+        lv_draw_arc(draw_ctx, dsc, center, UI_RING_RADIUS, start, start + 360);
+        return;
+    }
+    lv_draw_arc(draw_ctx, dsc, center, UI_RING_RADIUS, start % 360, (start + span) % 360);
+}
+
+static void ui_ring_event(lv_event_t *e)
+{
+    struct ui_ring *ring = lv_event_get_user_data(e);
+
+    if (lv_event_get_code(e) != LV_EVENT_DRAW_MAIN) {
+        return;
+    }
+
+    lv_draw_ctx_t *draw_ctx = lv_event_get_draw_ctx(e);
+    lv_point_t center = ui_ring_center(ring);
+    lv_draw_arc_dsc_t dsc;
+
+    lv_draw_arc_dsc_init(&dsc);
+    dsc.width = UI_RING_WIDTH;
+
+    // track first, the rounded end of the filled part overlaps it
+    dsc.color = lv_color_hex(0x404040);
+    ui_ring_draw_arc(draw_ctx, &dsc, &center, UI_RING_START + ring->angle, 360 - ring->angle);
+
+    dsc.color = lv_palette_main(LV_PALETTE_GREEN);
+    dsc.rounded = 1;
+    ui_ring_draw_arc(draw_ctx, &dsc, &center, UI_RING_START, ring->angle);
+}
+
+void ui_ring_create(struct ui_ring *ring, lv_obj_t *parent)
+{
+    ring->obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(ring->obj);
+    lv_obj_set_size(ring->obj, 2 * UI_RING_RADIUS + 1, 2 * UI_RING_RADIUS + 1);
+    lv_obj_center(ring->obj);
+    lv_obj_clear_flag(ring->obj, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(ring->obj, ui_ring_event, LV_EVENT_ALL, ring);
+    ring->angle = 0;
+}
+
+void ui_ring_set(struct ui_ring *ring, int32_t value)
+{
+    uint16_t angle = (uint16_t)(CLAMP(value, 0, UI_RING_MAX) * 360 / UI_RING_MAX);
+
+    if (angle == ring->angle) {
+        return;
+    }
+
+    uint16_t from = MIN(angle, ring->angle);
+    uint16_t to = MAX(angle, ring->angle);
+    lv_point_t center = ui_ring_center(ring);
+    lv_area_t area;
+
+    ring->angle = angle;
+    if (to - from >= 360) {
+        lv_obj_get_coords(ring->obj, &area);
+    } else {
+        // both ends rounded: covers the cap of the old end and of the new one
+        lv_draw_arc_get_area(center.x, center.y, UI_RING_RADIUS, (UI_RING_START + from) % 360,
+                             (UI_RING_START + to) % 360, UI_RING_WIDTH, true, &area);
+    }
+
+    stats.updates++;
+    stats.pixels += lv_area_get_size(&area);
+    lv_obj_invalidate_area(ring->obj, &area);
+}
+
+void ui_ring_get_stats(struct ui_ring_stats *out)
+{
+    *out = stats;
+}
+
+// ------------------ Shell Commands ------------------
+
+#if defined(CONFIG_SHELL) && defined(CONFIG_UI_PROGRESS_RING)
+static int cmd_ui_ring(const struct shell *sh, size_t argc, char **argv)
+{
+    struct ui_ring_stats s;
+
+    ui_ring_get_stats(&s);
+    shell_print(sh, "updates: %u, pixels: %u (%u per update)", s.updates, s.pixels,
+                s.updates ? s.pixels / s.updates : 0);
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((ui), ring, NULL, "Progress ring redrawn pixels", cmd_ui_ring, 1, 0);
+#endif
+
+// ------------------------ End of File ------------------------
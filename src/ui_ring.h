@@ -0,0 +1,71 @@
+/**
+ * @brief This is the ui_ring.h header of the application. Progress ring invalidating only the changed arc segment.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_ring.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_RING_H_
+#define UI_RING_H_
+
+// ------------------ Includes ------------------
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// ------------------ Macros ------------------
+
+#define UI_RING_RADIUS  116 ///< Outer radius, pixels, just inside the round display
+#define UI_RING_WIDTH   8   ///< Ring width, pixels
+#define UI_RING_START   270 ///< Angle the progress starts at, 12 o'clock (LVGL angles run clockwise from 3 o'clock)
+#define UI_RING_MAX     1000 ///< Progress range is 0 to UI_RING_MAX
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Progress ring widget.
+ */
+struct ui_ring {
+    lv_obj_t *obj;
+    uint16_t angle; ///< Filled part, degrees clockwise from UI_RING_START
+};
+
+/**
+ * @brief Progress ring statistics.
+ */
+struct ui_ring_stats {
+    uint32_t updates;   ///< Progress updates that moved the ring end by at least one degree
+    uint32_t pixels;    ///< Pixels invalidated, i.e. redrawn and sent to the display
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Create an empty ring centered on a screen.
+ *
+ * @param ring Widget to create.
+ * @param parent Screen to build on.
+ */
+void ui_ring_create(struct ui_ring *ring, lv_obj_t *parent);
+
+/**
+ * @brief Set the progress, invalidating only the arc segment between the old and new end.
+ *
+ * @param ring Widget.
+ * @param value Progress, 0 to UI_RING_MAX.
+ */
+void ui_ring_set(struct ui_ring *ring, int32_t value);
+
+/**
+ * @brief Get the progress ring statistics.
+ *
+ * @param stats Pointer to the statistics to fill in.
+ */
+void ui_ring_get_stats(struct ui_ring_stats *stats);
+
+#endif /* UI_RING_H_ */
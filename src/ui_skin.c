@@ -0,0 +1,44 @@
+/**
+ * @brief This is the ui_skin.c source code of the application. Slider skin drawn from pre-rendered sprites.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_skin.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_skin_page Sprite Skin
+ * @brief A rounded, bordered LVGL part is drawn through radius masks: every frame the knob
+ * moves, each of its pixels is masked and anti-aliased again, for the fill and the border. The
+ * skin draws the same shapes from sprites rendered once at build time (scripts/ui_sprites.py)
+ * in the display's own format, RGB565 with an alpha byte, so drawing a part is a plain alpha
+ * blit. The style keeps the part square and transparent, only its background image is drawn.
+ * Compare the draw cycles of "ui render" with CONFIG_UI_SKIN_SPRITES on and off.
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include "ui_skin.h"
+
+// ------------------ Functions ------------------
+
+void ui_skin_style(lv_style_t *style, const lv_img_dsc_t *sprite, lv_part_t part)
+{
+    lv_style_init(style);
+    lv_style_set_bg_opa(style, LV_OPA_TRANSP);
+    lv_style_set_bg_img_src(style, sprite);
+    lv_style_set_radius(style, 0);
+    lv_style_set_border_width(style, 0);
+    if (part == LV_PART_KNOB) {
+        // the slider sizes its knob from its height plus the padding
+        __ASSERT_NO_MSG(sprite->header.h >= UI_SKIN_TRACK_HEIGHT);
+        lv_style_set_pad_all(style, (sprite->header.h - UI_SKIN_TRACK_HEIGHT) / 2);
+    }
+}
+
+// ------------------------ End of File ------------------------
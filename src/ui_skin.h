@@ -0,0 +1,47 @@
+/**
+ * @brief This is the ui_skin.h header of the application. Slider skin drawn from pre-rendered sprites.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_skin.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_SKIN_H_
+#define UI_SKIN_H_
+
+// ------------------ Includes ------------------
+
+#include <lvgl.h>
+
+// ------------------ Macros ------------------
+
+// sprite sizes, the build renders the sprites with the same ones (CMakeLists.txt)
+#define UI_SKIN_TRACK_HEIGHT    10  ///< Slider height, pixels, the track sprite is UI_SLIDER_WIDTH_PX wide
+#define UI_SKIN_KNOB_SIZE       22  ///< Knob diameter, pixels
+
+// ------------------ Variables ------------------
+
+// rendered at build time by scripts/ui_sprites.py
+extern const lv_img_dsc_t ui_sprite_track;        ///< Grey rounded slider track
+extern const lv_img_dsc_t ui_sprite_knob_level;   ///< Green knob, "stay still"
+extern const lv_img_dsc_t ui_sprite_knob_tilted;  ///< Red knob, "move left/right"
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Initialize a style drawing a sprite centered on a slider part, with no radius or border.
+ *
+ * On LV_PART_MAIN the sprite is the track, on LV_PART_KNOB the knob: the knob area is padded
+ * around the slider height to the sprite size.
+ *
+ * @param style Style to initialize.
+ * @param sprite Sprite to draw.
+ * @param part LV_PART_MAIN or LV_PART_KNOB.
+ */
+void ui_skin_style(lv_style_t *style, const lv_img_dsc_t *sprite, lv_part_t part);
+
+#endif /* UI_SKIN_H_ */
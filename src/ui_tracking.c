@@ -0,0 +1,282 @@
+/**
+ * @brief This is the ui_tracking.c source code of the application. Tracking screen and its per-frame update.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_tracking.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page ui_tracking_page Tracking Screen
+ * @brief The screen shown while the device is held: status bar, slider following Ay, orientation
+ * and countdown labels, with the optional horizon and progress ring. The main thread runs one
+ * ui_tracking_frame() per UI frame; the latency benchmark (tests/latency) runs the same frames.
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include "fusion.h"
+#include "latency.h"
+#include "orient_bus.h"
+#include "tracker.h"
+#include "ui_gate.h"
+#include "ui_skin.h"
+#include "ui_tracking.h"
+
+// ------------------ Variables ------------------
+
+static lv_style_t style_main;
+static lv_style_t style_indicator;
+static lv_style_t style_pressed_color;
+static lv_style_t style_knob_level;  // green knob, "stay still"
+static lv_style_t style_knob_tilted; // red knob, "move left/right"
+
+#ifndef CONFIG_UI_SKIN_SPRITES
+static lv_style_transition_dsc_t transition_dsc;
+#endif
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Display system status including bluetooth status, logo and battery status.
+ */
+static void ui_tracking_status_bar(lv_obj_t *obj_cairdio_logo, lv_obj_t *obj_bluetooth_status,
+                                   lv_obj_t *obj_battery_status)
+{
+    // Initialize styles
+    static lv_style_t style;
+    lv_style_init(&style);
+
+    // Apply styles
+    lv_obj_add_style(obj_cairdio_logo, &style, 0);
+    lv_obj_add_style(obj_bluetooth_status, &style, 0);
+    lv_obj_add_style(obj_battery_status, &style, 0);
+
+    // Declare images
+    LV_IMG_DECLARE(cairdio_logo);
+    LV_IMG_DECLARE(bluetooth_connected);
+    LV_IMG_DECLARE(battery_50_percentage);
+
+    // Set sources
+    lv_img_set_src(obj_cairdio_logo, &cairdio_logo);
+    lv_img_set_src(obj_bluetooth_status, &bluetooth_connected);
+    lv_img_set_src(obj_battery_status, &battery_50_percentage);
+
+    // Set zoom and alignment
+    lv_img_set_zoom(obj_cairdio_logo, 150);
+    lv_img_set_zoom(obj_bluetooth_status, 100);
+    lv_img_set_zoom(obj_battery_status, 100);
+
+    lv_obj_align(obj_cairdio_logo, LV_ALIGN_CENTER, 0, -80); // top center
+    lv_obj_align(obj_bluetooth_status, LV_ALIGN_CENTER, -65, -78); // top left
+    lv_obj_align(obj_battery_status, LV_ALIGN_CENTER, 72, -78); // top right
+}
+
+#ifndef CONFIG_UI_SKIN_SPRITES
+/**
+ * @brief Initialize a knob style of the given color.
+ *
+ * @param style Style to initialize.
+ * @param palette Knob color.
+ */
+static void ui_tracking_knob_style(lv_style_t *style, lv_palette_t palette)
+{
+    lv_style_init(style);
+    lv_style_set_bg_opa(style, LV_OPA_COVER);
+    lv_style_set_bg_color(style, lv_palette_main(palette));
+    lv_style_set_border_color(style, lv_palette_darken(palette, 3));
+    lv_style_set_border_width(style, 2);
+    lv_style_set_radius(style, LV_RADIUS_CIRCLE);
+    lv_style_set_pad_all(style, 6); /*Makes the knob larger*/
+    lv_style_set_transition(style, &transition_dsc);
+}
+#endif
+
+/**
+ * @brief Apply the changed fields of the UI state to the tracking screen.
+ *
+ * @param t Tracking screen.
+ * @param changed Mask of the fields to apply, BIT(enum ui_field).
+ */
+static void ui_tracking_apply(struct ui_tracking *t, uint32_t changed)
+{
+    const struct ui_state *state = &t->ui;
+
+#ifdef CONFIG_UI_HORIZON
+    if (changed & (BIT(UI_FIELD_ROLL) | BIT(UI_FIELD_PITCH))) {
+        ui_horizon_set(&t->horizon, state->value[UI_FIELD_ROLL], state->value[UI_FIELD_PITCH]);
+    }
+#endif
+#ifdef CONFIG_UI_PROGRESS_RING
+    if (changed & BIT(UI_FIELD_PROGRESS)) {
+        ui_ring_set(&t->ring, state->value[UI_FIELD_PROGRESS]);
+    }
+#endif
+
+    if (changed & BIT(UI_FIELD_SLIDER)) {
+        // AY = -10 -> slider = 200, AY = 0 -> slider = 100, AY = 10 -> slider = 0
+        lv_slider_set_value(t->slider, state->value[UI_FIELD_SLIDER], LV_ANIM_OFF);
+    }
+
+    // orientation detection
+    if (changed & BIT(UI_FIELD_ORIENT)) {
+        int32_t orient = state->value[UI_FIELD_ORIENT];
+        bool tilted = ui_tracking_tilted(t);
+
+        lv_obj_remove_style(t->slider, tilted ? &style_knob_level : &style_knob_tilted, LV_PART_KNOB);
+        lv_obj_add_style(t->slider, tilted ? &style_knob_tilted : &style_knob_level, LV_PART_KNOB);
+
+        // "move right" if tilted towards -Y, "move left" if tilted towards +Y, "stay still" if level
+        lv_label_set_text(t->label, orient == STILLNESS_TILT_NEG ? "move right" :
+                          orient == STILLNESS_TILT_POS ? "move left" : "stay still");
+        lv_obj_set_style_text_color(t->label, lv_color_hex(tilted ? 0xFF0000 : 0x00FF00),
+                                    LV_PART_MAIN|LV_STATE_DEFAULT);
+        lv_obj_align_to(t->label, t->slider, LV_ALIGN_OUT_BOTTOM_MID, 0, 10);
+    }
+
+    if (changed & BIT(UI_FIELD_COUNTDOWN)) {
+        lv_label_set_text_fmt(t->count2_label, "Remaining: %d", (int)state->value[UI_FIELD_COUNTDOWN]);
+        lv_obj_align_to(t->count2_label, t->label, LV_ALIGN_OUT_BOTTOM_MID, 0, 10); // offset the count2_label below the label 10 pixels
+    }
+
+    if (changed & BIT(UI_FIELD_BLE)) {
+        if (state->value[UI_FIELD_BLE]) {
+            lv_obj_clear_flag(t->obj_bluetooth_status, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(t->obj_bluetooth_status, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+
+    // only the 50% battery image exists, hide it while the level is unknown
+    if (changed & BIT(UI_FIELD_BATTERY)) {
+        if (state->value[UI_FIELD_BATTERY] >= 0) {
+            lv_obj_clear_flag(t->obj_battery_status, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            lv_obj_add_flag(t->obj_battery_status, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+}
+
+void ui_tracking_create(struct ui_tracking *t, lv_obj_t *scr, uint32_t hold_ms)
+{
+    t->hold_ms = hold_ms;
+    t->ui.value[UI_FIELD_SLIDER] = UI_SLIDER_MAX / 2;
+    t->ui.value[UI_FIELD_ORIENT] = STILLNESS_HOLD;
+    t->ui.value[UI_FIELD_COUNTDOWN] = hold_ms / MSEC_PER_SEC;
+    t->ui.value[UI_FIELD_BATTERY] = 50;
+    t->ui.value[UI_FIELD_BLE] = 1;
+    t->ui.value[UI_FIELD_ROLL] = 0;
+    t->ui.value[UI_FIELD_PITCH] = 0;
+    t->ui.value[UI_FIELD_PROGRESS] = 0;
+
+#ifdef CONFIG_UI_HORIZON
+    // behind everything else, the widgets below are drawn over its spans
+    ui_horizon_create(&t->horizon, scr);
+#endif
+#ifdef CONFIG_UI_PROGRESS_RING
+    ui_ring_create(&t->ring, scr);
+#endif
+
+    // Create the status bar objects
+    t->obj_cairdio_logo = lv_img_create(scr); // cairdio logo
+    t->obj_bluetooth_status = lv_img_create(scr); // bluetooth status
+    t->obj_battery_status = lv_img_create(scr); // battery status
+    ui_tracking_status_bar(t->obj_cairdio_logo, t->obj_bluetooth_status, t->obj_battery_status);
+
+    // create a custom slider
+#ifdef CONFIG_UI_SKIN_SPRITES
+    // same look, blitted from sprites instead of masked every frame
+    ui_skin_style(&style_main, &ui_sprite_track, LV_PART_MAIN);
+    ui_skin_style(&style_knob_level, &ui_sprite_knob_level, LV_PART_KNOB);
+    ui_skin_style(&style_knob_tilted, &ui_sprite_knob_tilted, LV_PART_KNOB);
+#else
+    static const lv_style_prop_t props[] = {LV_STYLE_BG_COLOR, 0};
+    lv_style_transition_dsc_init(&transition_dsc, props, lv_anim_path_linear, 300, 0, NULL);
+    lv_style_init(&style_main); // background color of the slider
+    lv_style_set_bg_opa(&style_main, LV_OPA_COVER);
+    lv_style_set_bg_color(&style_main, lv_color_hex3(0xbbb));
+    lv_style_set_radius(&style_main, LV_RADIUS_CIRCLE);
+    lv_style_set_pad_ver(&style_main, -2); /*Makes the indicator larger*/
+    ui_tracking_knob_style(&style_knob_level, LV_PALETTE_GREEN);
+    ui_tracking_knob_style(&style_knob_tilted, LV_PALETTE_RED);
+#endif
+    lv_style_init(&style_indicator); // left side of the knob
+    lv_style_set_bg_opa(&style_indicator, LV_OPA_TRANSP); // using transparent color to hide the left side of the knob
+    lv_style_init(&style_pressed_color);
+    lv_style_set_bg_color(&style_pressed_color, lv_palette_darken(LV_PALETTE_CYAN, 2));
+
+    // Create the slider and apply styles
+    t->slider = lv_slider_create(scr);
+    lv_obj_remove_style_all(t->slider);        /*Remove the styles coming from the theme*/
+    lv_obj_add_style(t->slider, &style_main, LV_PART_MAIN);
+    lv_obj_add_style(t->slider, &style_indicator, LV_PART_INDICATOR);
+    lv_obj_add_style(t->slider, &style_pressed_color, LV_PART_INDICATOR | LV_STATE_PRESSED);
+    lv_obj_add_style(t->slider, &style_knob_level, LV_PART_KNOB);
+    lv_obj_add_style(t->slider, &style_pressed_color, LV_PART_KNOB | LV_STATE_PRESSED);
+    lv_obj_set_size(t->slider, UI_SLIDER_WIDTH_PX, UI_SKIN_TRACK_HEIGHT);
+    lv_slider_set_range(t->slider, 0, UI_SLIDER_MAX); // set the range of the slider to 0-200
+    lv_obj_center(t->slider);
+
+    // Create a label below the slider
+    t->label = lv_label_create(scr);
+    t->count2_label = lv_label_create(scr);
+    lv_obj_align_to(t->label, t->slider, LV_ALIGN_OUT_BOTTOM_MID, 0, 10); // offset the label below the slider 10 pixels
+
+    ui_tracking_apply(t, BIT_MASK(UI_FIELD_COUNT));
+    ui_gate_reset(&t->ui);
+}
+
+uint32_t ui_tracking_frame(struct ui_tracking *t, uint32_t remaining_ms)
+{
+    uint32_t changed;
+#ifdef CONFIG_UI_LATE_LATCH
+    struct orient_frame frame;
+
+    // latch the newest filtered output only when this frame is drawn right away, the knob then
+    // shows the chain's latest block instead of one posted up to a refresh period earlier
+    if (ui_gate_refresh_due() && tracker_latest(&frame) == 0) {
+#ifdef CONFIG_FUSION_PREDICT
+        // show where the device will be when the pixels reach the panel, not where it was
+        int64_t age_us = k_ticks_to_us_floor64(k_uptime_ticks()) - frame.sample.t_us;
+        uint32_t horizon_us = (uint32_t)CLAMP(age_us, 0, UINT32_MAX / 2) + latency_display_us();
+        float roll = fusion_predict(frame.roll, frame.sample.gyr[0], horizon_us);
+        float pitch = fusion_predict(frame.pitch, frame.sample.gyr[1], horizon_us);
+
+        // move the filtered Ay by the change of gravity along Y over the predicted rotation
+        frame.sample.acc[1] += (int32_t)(IMU_GRAVITY_UMS2 * (sinf(roll) * cosf(pitch) -
+                                                            sinf(frame.roll) * cosf(frame.pitch)));
+        frame.roll = roll;
+        frame.pitch = pitch;
+#endif
+        ui_mbox_post(UI_FIELD_SLIDER, tracker_slider_from_frame(&frame));
+#ifdef CONFIG_UI_HORIZON
+        ui_mbox_post(UI_FIELD_ROLL, (int32_t)(frame.roll * 1000.0f));
+        ui_mbox_post(UI_FIELD_PITCH, (int32_t)(frame.pitch * 1000.0f));
+#endif
+        latency_stamp_processed(frame.sample.t_us);
+    }
+#endif
+
+    // whole seconds left, rounded up so "Remaining: 0" is never shown while holding
+    ui_mbox_post(UI_FIELD_COUNTDOWN, (int32_t)DIV_ROUND_UP(remaining_ms, MSEC_PER_SEC));
+    ui_mbox_post(UI_FIELD_PROGRESS,
+                 (int32_t)((uint64_t)(t->hold_ms - remaining_ms) * UI_RING_MAX / t->hold_ms));
+
+    // apply every update posted since the last frame in one batch, dropping the ones
+    // that would redraw identical pixels
+    changed = ui_mbox_take(&t->ui);
+    changed = ui_gate_filter(&t->ui, changed);
+    ui_tracking_apply(t, changed);
+    if (changed & BIT(UI_FIELD_SLIDER)) {
+        latency_stamp_applied();
+    }
+    return changed;
+}
+
+// ------------------------ End of File ------------------------
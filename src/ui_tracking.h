@@ -0,0 +1,85 @@
+/**
+ * @brief This is the ui_tracking.h header of the application. Tracking screen and its per-frame update.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file ui_tracking.h
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+#ifndef UI_TRACKING_H_
+#define UI_TRACKING_H_
+
+// ------------------ Includes ------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <lvgl.h>
+#include "stillness.h"
+#include "ui_horizon.h"
+#include "ui_mbox.h"
+#include "ui_ring.h"
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Widgets of the tracking screen, built ahead of the session and updated in place.
+ */
+struct ui_tracking {
+    lv_obj_t *obj_cairdio_logo;
+    lv_obj_t *obj_bluetooth_status;
+    lv_obj_t *obj_battery_status;
+    lv_obj_t *slider;
+    lv_obj_t *label;
+    lv_obj_t *count2_label;
+#ifdef CONFIG_UI_HORIZON
+    struct ui_horizon horizon;
+#endif
+#ifdef CONFIG_UI_PROGRESS_RING
+    struct ui_ring ring;
+#endif
+    struct ui_state ui;     ///< Latest UI state, updated from the mailbox once per frame
+    uint32_t hold_ms;       ///< Level hold that completes the session, ms
+};
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Build the tracking screen: horizon, progress ring, status bar, slider, orientation and countdown labels.
+ *
+ * @param t Widgets to create.
+ * @param scr Screen to build on.
+ * @param hold_ms Level hold that completes the session, ms, shown as the initial countdown.
+ */
+void ui_tracking_create(struct ui_tracking *t, lv_obj_t *scr, uint32_t hold_ms);
+
+/**
+ * @brief One frame of the tracking screen, right before ui_gate_render().
+ *
+ * With CONFIG_UI_LATE_LATCH the newest orientation is latched into the mailbox when the refresh
+ * is due. The countdown and progress are posted, then every update posted since the last frame
+ * is applied in one batch, without the ones that would redraw identical pixels.
+ *
+ * @param t Tracking screen.
+ * @param remaining_ms Time left in the hold, ms.
+ * @return uint32_t Mask of the fields applied, BIT(enum ui_field).
+ */
+uint32_t ui_tracking_frame(struct ui_tracking *t, uint32_t remaining_ms);
+
+/**
+ * @brief Whether the orientation shown is tilted, the hold then restarts.
+ *
+ * @param t Tracking screen.
+ * @return true if tilted towards either side.
+ */
+static inline bool ui_tracking_tilted(const struct ui_tracking *t)
+{
+    int32_t orient = t->ui.value[UI_FIELD_ORIENT];
+
+    return orient == STILLNESS_TILT_NEG || orient == STILLNESS_TILT_POS;
+}
+
+#endif /* UI_TRACKING_H_ */
@@ -0,0 +1,93 @@
+/**
+ * @brief This is the main.c source code of the imu_num test. Accuracy and cycles of the filter chain numeric backends.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file main.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page imu_num_test_page Numeric Backend Suite
+ * @brief Built once per CONFIG_IMU_NUM backend (see testcase.yaml). The filter chain is checked
+ * against its double precision reference and for unity gain at DC, and the cycles per block
+ * are printed so the backends can be compared on the same core.
+ */
+
+// ------------------ Includes ------------------
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include "imu_dsp.h"
+#include "imu_num.h"
+
+// ------------------ Macros ------------------
+
+/** Largest accepted error against the reference, micro m/s^2 */
+#if defined(CONFIG_IMU_NUM_Q15)
+#define TEST_ERR_MAX_UMS2   5000    ///< 1024 micro units per LSB, 3.7 mm/s^2 max through the default chain
+#else
+#define TEST_ERR_MAX_UMS2   1000
+#endif
+
+#define TEST_DC_SAMPLES     (30 * CONFIG_IMU_DSP_BLOCK_SIZE) ///< Long enough for the chain to settle
+
+// ------------------ Functions ------------------
+
+static void *imu_num_setup(void)
+{
+    zassert_ok(imu_dsp_init(), "filter chain not initialized");
+    return NULL;
+}
+
+ZTEST(imu_num, test_reference_accuracy)
+{
+    struct imu_dsp_check_result r;
+
+    zassert_ok(imu_dsp_check(&r), "check did not run");
+    TC_PRINT("backend: %s, outputs: %u, cycles/block/channel max: %u\n", IMU_NUM_NAME, r.outputs,
+             r.cycles_max);
+    TC_PRINT("error vs double reference: max %u, rms %u (micro m/s^2)\n", r.err_max, r.err_rms);
+
+    zassert_true(r.outputs > 0, "no outputs compared");
+    zassert_true(r.err_max <= TEST_ERR_MAX_UMS2, "%s max error %u over %u", IMU_NUM_NAME,
+                 r.err_max, TEST_ERR_MAX_UMS2);
+    zassert_true(r.err_rms <= r.err_max, "rms above max");
+}
+
+ZTEST(imu_num, test_dc_gain)
+{
+    const struct imu_sample in = {
+        .acc = { IMU_GRAVITY_UMS2 / 2, -IMU_GRAVITY_UMS2 / 4, IMU_GRAVITY_UMS2 },
+        .gyr = { 1000000, -500000, 0 },
+    };
+    struct imu_sample out[IMU_DSP_OUT_MAX];
+    struct imu_dsp_stats s;
+    int n = 0;
+
+    zassert_ok(imu_dsp_init(), "filter chain not reset");
+    for (int i = 0; i < TEST_DC_SAMPLES; i++) {
+        n = imu_dsp_push(&in, out);
+    }
+    zassert_equal(n, IMU_DSP_OUT_MAX, "the last sample did not complete a block");
+
+    for (int i = 0; i < 3; i++) {
+        zassert_within(out[n - 1].acc[i], in.acc[i], TEST_ERR_MAX_UMS2, "acc[%d] %d, expected %d",
+                       i, out[n - 1].acc[i], in.acc[i]);
+        zassert_within(out[n - 1].gyr[i], in.gyr[i], TEST_ERR_MAX_UMS2, "gyr[%d] %d, expected %d",
+                       i, out[n - 1].gyr[i], in.gyr[i]);
+    }
+
+    imu_dsp_get_stats(&s);
+    TC_PRINT("backend: %s, block: %u samples, blocks: %u, cycles/block max: %u, avg: %u, "
+             "avg/sample: %u\n", IMU_NUM_NAME, CONFIG_IMU_DSP_BLOCK_SIZE, s.blocks, s.cycles_max,
+             s.blocks ? (uint32_t)(s.cycles_total / s.blocks) : 0,
+             s.blocks ? (uint32_t)(s.cycles_total / s.blocks / CONFIG_IMU_DSP_BLOCK_SIZE) : 0);
+}
+
+ZTEST_SUITE(imu_num, NULL, imu_num_setup, NULL, NULL, NULL);
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,217 @@
+/**
+ * @brief This is the main.c source code of the latency test. Motion-to-photon latency benchmark on native_posix.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file main.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page latency_test_page Latency Benchmark
+ * @brief The emulated BMI270 replays a tilt sweep, stepped one frame per ODR period, through the
+ * application's acquisition, fusion, tracker and UI mailbox onto its tracking screen
+ * (src/ui_tracking.c), rendered to the dummy display by the same ui_tracking_frame() and
+ * ui_gate_render() calls as the main thread. The percentiles of every latency stage are printed
+ * and checked against the frame budget.
+ *
+ * native_posix runs on simulated time: the CPU work of rendering and transferring a frame takes
+ * no simulated time, so the render and transfer stages read ~0 and the total bounds the sample
+ * age, scheduling and latch policy of the pipeline, not its draw cost. The draw cost is the
+ * "ui render" cycles printed at the end, which are the host's.
+ */
+
+// ------------------ Includes ------------------
+
+#include <math.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/ztest.h>
+#include <lvgl.h>
+#include "emul/bmi270_emul.h"
+#include "imu.h"
+#include "imu_acq.h"
+#include "imu_power.h"
+#include "imu_rec.h"
+#include "imu_warmup.h"
+#include "latency.h"
+#include "tracker.h"
+#include "ui_gate.h"
+#include "ui_port.h"
+#include "ui_tracking.h"
+
+// ------------------ Macros ------------------
+
+#define IMU_NODE                DT_COMPAT_GET_ANY_STATUS_OKAY(bosch_bmi270)
+
+#define TEST_PERIOD_US          (USEC_PER_SEC / IMU_ODR_HZ)
+#define TEST_SWEEP_FRAMES       200     ///< One +-TEST_SWEEP_DEG roll sweep, 2 s
+#define TEST_SWEEP_DEG          30
+#define TEST_FRAMES             1000    ///< Frames stepped while measuring, 10 s
+#define TEST_WARMUP_FRAMES      500     ///< Frames the warm-up may take at most
+#define TEST_HOLD_MS            10000   ///< Level hold of the tracking screen, as the application's
+
+/** A value is latched when the refresh is due and drawn right away. Its sample is the last of
+ * the newest filter block, at most one block plus one ODR period old (the acquisition timer's
+ * phase), plus one refresh period of slack. */
+#define TEST_TOTAL_MAX_US       ((uint32_t)((CONFIG_IMU_DSP_BLOCK_SIZE + 1) * TEST_PERIOD_US + \
+                                            CONFIG_LV_DISP_DEF_REFR_PERIOD * USEC_PER_MSEC))
+
+// ------------------ Variables ------------------
+
+static const struct device *const sensor_dev = DEVICE_DT_GET(IMU_NODE);
+static const struct emul *const sensor_emul = EMUL_DT_GET(IMU_NODE);
+static struct ui_tracking tracking;
+static int64_t deadline;
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Record a roll sweep to replay, gravity in the Y/Z plane and the matching X rate.
+ */
+static void latency_test_trace(void)
+{
+    struct imu_rec_frame frame;
+    const uint8_t *trace;
+    size_t len;
+
+    imu_rec_start();
+    for (int i = 0; i < TEST_SWEEP_FRAMES; i++) {
+        float phase = 2.0f * (float)M_PI * i / TEST_SWEEP_FRAMES;
+        float amp = TEST_SWEEP_DEG * (float)M_PI / 180.0f;
+        float roll = amp * sinf(phase);
+        float rate = amp * cosf(phase) * 2.0f * (float)M_PI * IMU_ODR_HZ / TEST_SWEEP_FRAMES;
+        struct imu_sample sample = {
+            .acc = { 0, (int32_t)(IMU_GRAVITY_UMS2 * sinf(roll)),
+                     (int32_t)(IMU_GRAVITY_UMS2 * cosf(roll)) },
+            .gyr = { (int32_t)(rate * 1e6f), 0, 0 },
+        };
+
+        imu_rec_frame_from_sample(&sample, i * TEST_PERIOD_US, &frame);
+        zassert_ok(imu_rec_push(&frame), "trace does not fit the recording buffer");
+    }
+    imu_rec_stop();
+
+    len = imu_rec_get(&trace);
+    zassert_ok(bmi270_emul_set_trace(sensor_emul, trace, len), "trace rejected");
+}
+
+/**
+ * @brief Advance the sensor by one frame and let the acquisition thread publish it.
+ */
+static void latency_test_step(void)
+{
+    bmi270_emul_step(sensor_emul);
+    k_sleep(K_USEC(TEST_PERIOD_US));
+}
+
+/**
+ * @brief One UI frame, as the application's tracking frame: the hold restarts while tilted.
+ */
+static void latency_test_frame(void)
+{
+    int64_t now = k_uptime_get();
+
+    if (ui_tracking_tilted(&tracking)) {
+        deadline = now + TEST_HOLD_MS;
+    }
+    ui_tracking_frame(&tracking, (uint32_t)CLAMP(deadline - now, 0, TEST_HOLD_MS));
+    ui_gate_render();
+}
+
+static void *latency_setup(void)
+{
+    const struct device *display_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
+    int ret = -EAGAIN;
+
+    zassert_true(device_is_ready(sensor_dev), "sensor not ready");
+    zassert_true(device_is_ready(display_dev), "display not ready");
+
+#ifdef CONFIG_UI_PORT
+    ui_port_init(display_dev);
+#endif
+    ui_gate_init();
+
+    latency_test_trace();
+
+    imu_warmup_start(sensor_dev);
+    for (int i = 0; i < TEST_WARMUP_FRAMES; i++) {
+        ret = imu_warmup_wait(K_NO_WAIT);
+        if (ret != -EAGAIN) {
+            break;
+        }
+        latency_test_step();
+    }
+    zassert_ok(ret, "IMU warm-up did not succeed: %d", ret);
+
+    return NULL;
+}
+
+ZTEST(latency, test_motion_to_photon)
+{
+    static const char *const names[] = {
+        [LATENCY_PROCESS] = "process",
+        [LATENCY_RENDER] = "render",
+        [LATENCY_TRANSFER] = "transfer",
+        [LATENCY_AGE] = "age",
+        [LATENCY_TOTAL] = "total",
+    };
+    struct latency_stats s;
+    struct ui_gate_stats g;
+    lv_obj_t *scr = lv_obj_create(NULL);
+
+    // the application's tracking screen, loaded as on entering APP_TRACKING
+    ui_tracking_create(&tracking, scr, TEST_HOLD_MS);
+    ui_gate_transition();
+    lv_scr_load(scr);
+    deadline = k_uptime_get() + TEST_HOLD_MS;
+
+    zassert_ok(imu_power_session(true), "no IMU session");
+    zassert_ok(imu_acq_start(), "acquisition not started");
+    tracker_start();
+    latency_reset();
+
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        latency_test_step();
+        latency_test_frame();
+    }
+
+    imu_acq_stop();
+    tracker_stop();
+    imu_power_session(false);
+
+    latency_get_stats(&s);
+    TC_PRINT("frames: %u, values replaced: %u, window: %u\n", s.frames, s.replaced, s.window);
+    TC_PRINT("%-9s %8s %8s %8s %8s (us)\n", "stage", "p50", "p90", "p99", "max");
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        TC_PRINT("%-9s %8u %8u %8u %8u\n", names[i], s.stage[i].p50, s.stage[i].p90,
+                 s.stage[i].p99, s.stage[i].max);
+    }
+    ui_gate_get_stats(&g);
+    TC_PRINT("ui render (%s skin, %s RGB565): rendered %u, skipped %u, waited %u, "
+             "draw cycles/frame avg %u, max %u\n",
+             IS_ENABLED(CONFIG_UI_SKIN_SPRITES) ? "sprite" : "style",
+             IS_ENABLED(CONFIG_LV_COLOR_16_SWAP) ? "swapped" : "native", g.rendered, g.skipped,
+             g.waited,
+             g.rendered ? (uint32_t)(g.draw_cycles_total / g.rendered) : 0, g.draw_cycles_max);
+
+    // the sweep moves the slider in most refresh periods, each of them is one measured frame
+    zassert_true(s.frames >= TEST_FRAMES * TEST_PERIOD_US / USEC_PER_MSEC /
+                 CONFIG_LV_DISP_DEF_REFR_PERIOD / 2, "only %u frames measured", s.frames);
+    for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+        zassert_true(s.stage[i].p50 <= s.stage[i].p90 && s.stage[i].p90 <= s.stage[i].p99 &&
+                     s.stage[i].p99 <= s.stage[i].max, "%s percentiles out of order", names[i]);
+    }
+    zassert_true(s.stage[LATENCY_AGE].max <= s.stage[LATENCY_TOTAL].max, "frame drawn before its sample");
+    zassert_true(s.stage[LATENCY_TOTAL].p99 <= TEST_TOTAL_MAX_US,
+                 "motion to photon p99 %u us over %u us", s.stage[LATENCY_TOTAL].p99,
+                 TEST_TOTAL_MAX_US);
+}
+
+ZTEST_SUITE(latency, NULL, latency_setup, NULL, NULL, NULL);
+
+// ------------------------ End of File ------------------------
@@ -0,0 +1,325 @@
+/**
+ * @brief This is the main.c source code of the stillness test. False hold restarts and cycles of the stillness detector.
+ * @code
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause.
+ * @endcode
+ *
+ * @file main.c
+ * @version 1.0
+ * @author Shaun Lin (hl116@rice.edu)
+ * @copyright Rice University & HealthSeers Inc. Ⓒ 2024
+ */
+
+/**
+ * @page stillness_test_page Stillness Detector Suite
+ * @brief Ay of a session is replayed through stillness_update() (src/stillness.c) and through
+ * the single-sample check it replaced (truncated Ay < -1 / Ay > 1), for several windows and
+ * dwell times. Every reported tilt restarts the hold countdown; a restart is false when Ay does
+ * not actually stay tilted: the median Ay over the following STILLNESS_TEST_CONFIRM_MS is not
+ * beyond CONFIG_STILLNESS_LEVEL_ENTER_MMS2 on the same side. The cycles of every
+ * stillness_update() call are measured with the timing API.
+ *
+ * The session is CONFIG_STILLNESS_TEST_TRACE_FILE, or a synthetic hand-held hold.
+ */
+
+// ------------------ Includes ------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+#include "imu.h"
+#include "stillness.h"
+
+// ------------------ Macros ------------------
+
+#define STILLNESS_TEST_SAMPLES_MAX  12000   ///< Longest replayed session, 2 min at IMU_ODR_HZ
+#define STILLNESS_TEST_CONFIRM_MS   500     ///< Time a real tilt lasts at least
+#define STILLNESS_TEST_CONFIRM_MAX  256     ///< Samples the confirmation median is taken over at most
+
+// synthetic session, at IMU_ODR_HZ
+#define SYNTH_SECONDS               60
+#define SYNTH_NOISE_UMS2            60000   ///< Hand-held noise on Ay, rms
+#define SYNTH_SPIKE_PERIOD          73      ///< Samples between single-sample spikes
+#define SYNTH_SPIKE_UMS2            2600000
+#define SYNTH_BUMP_PERIOD           910     ///< Samples between short bumps
+#define SYNTH_BUMP_SAMPLES          8       ///< 80 ms, shorter than the dwell time
+#define SYNTH_BUMP_UMS2             2500000
+#define SYNTH_TILT_SAMPLES          250     ///< Plateau of a real tilt, 2.5 s
+#define SYNTH_TILT_RAMP             20      ///< Ramp into and out of a real tilt, 200 ms
+#define SYNTH_TILT_UMS2             3500000
+
+// ------------------ Typedefs ------------------
+
+/**
+ * @brief Outcome of one replay.
+ */
+struct stillness_test_result {
+    uint32_t restarts;  ///< Tilts reported, each restarts the hold countdown
+    uint32_t false_restarts; ///< Restarts not confirmed by the following samples
+    uint32_t cycles_avg; ///< stillness_update() cycles per sample, average
+    uint32_t cycles_max; ///< stillness_update() cycles per sample, worst case
+};
+
+// ------------------ Variables ------------------
+
+static int32_t ay[STILLNESS_TEST_SAMPLES_MAX];   // micro m/s^2, as the tracker passes it
+static uint32_t t_us[STILLNESS_TEST_SAMPLES_MAX];
+static size_t samples;
+
+/** Starts of the real tilts of the synthetic session, seconds */
+static const uint8_t synth_tilts[] = { 10, 25, 40, 52 };
+
+#ifdef STILLNESS_TEST_TRACE
+static const char trace_csv[] = {
+#include "stillness_test_trace.inc"
+};
+#endif
+
+// ------------------ Functions ------------------
+
+/**
+ * @brief Standard normal value from 12 uniform ones, from a fixed seed so every run replays the same session.
+ */
+static float stillness_test_gauss(void)
+{
+    static uint32_t seed = 1;
+    float sum = 0.0f;
+
+    for (int i = 0; i < 12; i++) {
+        seed = seed * 1664525U + 1013904223U;
+        sum += (seed >> 8) * (1.0f / (1 << 24));
+    }
+    return sum - 6.0f;
+}
+
+/**
+ * @brief Build the synthetic hand-held hold at IMU_ODR_HZ.
+ */
+static void stillness_test_synth(void)
+{
+    samples = SYNTH_SECONDS * IMU_ODR_HZ;
+
+    for (size_t i = 0; i < samples; i++) {
+        int32_t v = (int32_t)(stillness_test_gauss() * SYNTH_NOISE_UMS2);
+
+        if (i % SYNTH_SPIKE_PERIOD == SYNTH_SPIKE_PERIOD - 1) {
+            v += (i / SYNTH_SPIKE_PERIOD) & 1 ? -SYNTH_SPIKE_UMS2 : SYNTH_SPIKE_UMS2;
+        }
+        if (i % SYNTH_BUMP_PERIOD >= SYNTH_BUMP_PERIOD - SYNTH_BUMP_SAMPLES) {
+            v += (i / SYNTH_BUMP_PERIOD) & 1 ? -SYNTH_BUMP_UMS2 : SYNTH_BUMP_UMS2;
+        }
+        for (size_t k = 0; k < ARRAY_SIZE(synth_tilts); k++) {
+            int32_t start = synth_tilts[k] * IMU_ODR_HZ;
+            int32_t pos = (int32_t)i - start;
+            int32_t level = k & 1 ? -SYNTH_TILT_UMS2 : SYNTH_TILT_UMS2;
+
+            if (pos >= 0 && pos < SYNTH_TILT_RAMP) {
+                v += level / SYNTH_TILT_RAMP * pos;
+            } else if (pos >= SYNTH_TILT_RAMP && pos < SYNTH_TILT_RAMP + SYNTH_TILT_SAMPLES) {
+                v += level;
+            } else if (pos >= SYNTH_TILT_RAMP + SYNTH_TILT_SAMPLES &&
+                       pos < 2 * SYNTH_TILT_RAMP + SYNTH_TILT_SAMPLES) {
+                v += level / SYNTH_TILT_RAMP * (2 * SYNTH_TILT_RAMP + SYNTH_TILT_SAMPLES - pos);
+            }
+        }
+        ay[i] = v;
+        t_us[i] = i * (USEC_PER_SEC / IMU_ODR_HZ);
+    }
+}
+
+#ifdef STILLNESS_TEST_TRACE
+/**
+ * @brief Load Ay of the embedded CSV (t_us,ax,ay,az,gx,gy,gz register values), header lines skipped.
+ */
+static void stillness_test_load(void)
+{
+    const char *p = trace_csv;
+    const char *end = trace_csv + sizeof(trace_csv);
+
+    samples = 0;
+    while (p < end && samples < STILLNESS_TEST_SAMPLES_MAX) {
+        const char *eol = memchr(p, '\n', end - p);
+        long v[3];
+        char *next = (char *)p;
+
+        eol = eol ? eol : end;
+        if (*p >= '0' && *p <= '9') {
+            for (int i = 0; i < 3; i++) {
+                v[i] = strtol(next, &next, 10);
+                next++; // ','
+            }
+            t_us[samples] = (uint32_t)v[0];
+            ay[samples] = (int32_t)(v[2] * IMU_ACCEL_RANGE_UMS2 / 32768);
+            samples++;
+        }
+        p = eol + 1;
+    }
+}
+#endif
+
+/**
+ * @brief The check stillness_update() replaced: integer m/s^2, truncated, against +-1.
+ */
+static enum stillness_state stillness_test_legacy(int32_t value)
+{
+    int32_t a = value / 1000000;
+
+    if (a < -1) {
+        return STILLNESS_TILT_NEG;
+    }
+    if (a > 1) {
+        return STILLNESS_TILT_POS;
+    }
+    return STILLNESS_HOLD;
+}
+
+/**
+ * @brief Whether a tilt reported at sample i is false: the median Ay over the following
+ * STILLNESS_TEST_CONFIRM_MS is not beyond the tilt end threshold on its side.
+ */
+static bool stillness_test_is_false(size_t i, enum stillness_state state)
+{
+    static int32_t buf[STILLNESS_TEST_CONFIRM_MAX];
+    const int32_t level = CONFIG_STILLNESS_LEVEL_ENTER_MMS2 * 1000;
+    size_t n = 0;
+
+    for (size_t j = i; j < samples && n < ARRAY_SIZE(buf) &&
+         t_us[j] - t_us[i] <= STILLNESS_TEST_CONFIRM_MS * USEC_PER_MSEC; j++) {
+        // insertion sort, the window is short
+        size_t k = n++;
+
+        while (k > 0 && buf[k - 1] > ay[j]) {
+            buf[k] = buf[k - 1];
+            k--;
+        }
+        buf[k] = ay[j];
+    }
+
+    int32_t median = buf[n / 2];
+
+    return state == STILLNESS_TILT_NEG ? median >= -level : median <= level;
+}
+
+/**
+ * @brief Count the restarts of a sequence of states, one per call, in sample order.
+ */
+static void stillness_test_count(struct stillness_test_result *r, size_t i,
+                                 enum stillness_state state, enum stillness_state *prev)
+{
+    if ((state == STILLNESS_TILT_NEG || state == STILLNESS_TILT_POS) && state != *prev) {
+        r->restarts++;
+        r->false_restarts += stillness_test_is_false(i, state);
+    }
+    *prev = state;
+}
+
+/**
+ * @brief Replay the session through the detector, timing every update.
+ */
+static void stillness_test_replay(uint16_t window, uint32_t dwell_ms,
+                                  struct stillness_test_result *r)
+{
+    const struct stillness_config cfg = {
+        .window = window,
+        .level_enter = CONFIG_STILLNESS_LEVEL_ENTER_MMS2 / 1000.0f,
+        .level_exit = CONFIG_STILLNESS_LEVEL_EXIT_MMS2 / 1000.0f,
+        .std_max = CONFIG_STILLNESS_STD_MAX_MMS2 / 1000.0f,
+        .dwell_us = dwell_ms * 1000U,
+    };
+    static struct stillness s;
+    enum stillness_state prev = STILLNESS_HOLD;
+    uint64_t total = 0;
+
+    memset(r, 0, sizeof(*r));
+    stillness_init(&s, &cfg);
+
+    for (size_t i = 0; i < samples; i++) {
+        timing_t start = timing_counter_get();
+        enum stillness_state state = stillness_update(&s, ay[i], t_us[i]);
+        timing_t end = timing_counter_get();
+        uint32_t cycles = (uint32_t)timing_cycles_get(&start, &end);
+
+        total += cycles;
+        r->cycles_max = MAX(r->cycles_max, cycles);
+        stillness_test_count(r, i, state, &prev);
+    }
+    r->cycles_avg = (uint32_t)(total / samples);
+}
+
+static void stillness_test_print(const char *name, const struct stillness_test_result *r)
+{
+    uint32_t minutes_x10 = (t_us[samples - 1] - t_us[0]) / (6 * USEC_PER_SEC);
+    uint32_t per_min_x10 = minutes_x10 ? 100 * r->false_restarts / minutes_x10 : 0;
+
+    TC_PRINT("%-20s %8u %8u %6u%% %7u.%u", name, r->restarts, r->false_restarts,
+             r->restarts ? 100 * r->false_restarts / r->restarts : 0, per_min_x10 / 10,
+             per_min_x10 % 10);
+    if (r->cycles_max) {
+        TC_PRINT(" %6u %6u (%u ns avg)\n", r->cycles_avg, r->cycles_max,
+                 (uint32_t)timing_cycles_to_ns(r->cycles_avg));
+    } else {
+        TC_PRINT(" %6s %6s\n", "-", "-");
+    }
+}
+
+static void *stillness_setup(void)
+{
+#ifdef STILLNESS_TEST_TRACE
+    stillness_test_load();
+#else
+    stillness_test_synth();
+#endif
+    zassert_true(samples > 1, "no session to replay");
+
+    timing_init();
+    timing_start();
+    return NULL;
+}
+
+ZTEST(stillness, test_false_restarts)
+{
+    static const uint16_t windows[] = { 10, 25, 50, 100 };
+    static const uint32_t dwells_ms[] = { 100, 200 };
+    struct stillness_test_result legacy = { 0 };
+    struct stillness_test_result r;
+    enum stillness_state prev = STILLNESS_HOLD;
+    char name[24];
+
+    TC_PRINT("%u samples, %u.%u s\n", (uint32_t)samples, (t_us[samples - 1] - t_us[0]) / USEC_PER_SEC,
+             (t_us[samples - 1] - t_us[0]) % USEC_PER_SEC / (USEC_PER_SEC / 10));
+    TC_PRINT("%-20s %8s %8s %7s %9s %6s %6s\n", "detector", "restarts", "false", "rate",
+             "false/min", "cyc", "max");
+
+    for (size_t i = 0; i < samples; i++) {
+        stillness_test_count(&legacy, i, stillness_test_legacy(ay[i]), &prev);
+    }
+    stillness_test_print("single sample", &legacy);
+
+    for (size_t w = 0; w < ARRAY_SIZE(windows); w++) {
+        for (size_t d = 0; d < ARRAY_SIZE(dwells_ms); d++) {
+            if (windows[w] > CONFIG_STILLNESS_WINDOW_MAX) {
+                continue;
+            }
+            stillness_test_replay(windows[w], dwells_ms[d], &r);
+            snprintk(name, sizeof(name), "window %u dwell %u", windows[w], dwells_ms[d]);
+            stillness_test_print(name, &r);
+        }
+    }
+
+    stillness_test_replay(CONFIG_STILLNESS_WINDOW, CONFIG_STILLNESS_DWELL_MS, &r);
+    zassert_true(r.false_restarts <= legacy.false_restarts,
+                 "detector restarts falsely more often than the single-sample check: %u > %u",
+                 r.false_restarts, legacy.false_restarts);
+#ifndef STILLNESS_TEST_TRACE
+    zassert_equal(r.false_restarts, 0, "%u false restarts on the synthetic session",
+                  r.false_restarts);
+    zassert_equal(r.restarts, ARRAY_SIZE(synth_tilts), "%u of %u real tilts reported",
+                  r.restarts, (uint32_t)ARRAY_SIZE(synth_tilts));
+#endif
+}
+
+ZTEST_SUITE(stillness, NULL, stillness_setup, NULL, NULL, NULL);
+
+// ------------------------ End of File ------------------------